@@ -15,8 +15,38 @@
 extern "C" {
 #endif
 
+/* Slider attack indexing schemes; PEXT needs x86-64 BMI2 and is chosen by CPUID. */
+typedef enum SliderBackend {
+    SLIDER_BACKEND_MAGIC = 0,
+    SLIDER_BACKEND_PEXT = 1
+} SliderBackend;
+
 void engine_init(void);
+
+/*
+ * An independent engine instance: its own transposition table, eval cache and TT aging.
+ * Attack, zobrist and evaluation tables and the opening book are built by engine_init and
+ * shared read-only. One instance runs one search at a time; concurrent games each need
+ * their own. The calls without an Engine argument use a process-wide default instance.
+ */
+typedef struct Engine Engine;
+
+/* hash_mb <= 0 selects the default size; the table is allocated on the first search. */
+Engine* engine_create(int hash_mb);
+void engine_destroy(Engine* engine);
+/* Forgets everything learned (new game); also allocates a table not yet in use. */
+void engine_clear(Engine* engine);
+/* Resizes (MB, clears) the instance's table; call only while it is not searching. */
+bool engine_resize_hash(Engine* engine, int size_mb);
+int engine_hash_size(const Engine* engine);
+
 void engine_reset_transposition_table(void);
+/* Resizes the default instance's transposition table (MB, clears it); call only while no search runs. */
+bool engine_set_hash_size(int size_mb);
+int engine_get_hash_size(void);
+/* True when the table was mmap'd with MADV_HUGEPAGE (Linux); false for the malloc fallback. */
+bool engine_hash_uses_huge_pages(void);
+SliderBackend engine_get_slider_backend(void);
 
 /* Position lifecycle helpers. */
 void position_set_empty(Position* pos);
@@ -31,11 +61,16 @@ Bitboard engine_get_king_attacks(int square);
 Bitboard engine_get_pawn_attacks(Side side, int square);
 Bitboard engine_get_bishop_attacks(int square, Bitboard occupancy);
 Bitboard engine_get_rook_attacks(int square, Bitboard occupancy);
+Bitboard engine_get_between(int from, int to);
+Bitboard engine_get_line(int a, int b);
 
 /* Tactical helpers. */
 int engine_find_king_square(const Position* pos, Side side);
+Bitboard engine_attackers_to(const Position* pos, int square, Bitboard occupancy);
 bool engine_is_square_attacked(const Position* pos, int square, Side by_side);
 bool engine_in_check(const Position* pos, Side side);
+/* Static exchange evaluation in centipawns for the side making `move` (negative = losing capture). */
+int engine_see(const Position* pos, Move move);
 
 /* Board inspection and piece presentation helpers. */
 bool position_piece_at(const Position* pos, int square, Side* out_side, PieceType* out_piece);
@@ -43,13 +78,50 @@ char piece_to_char(Side side, PieceType piece);
 
 /* Move generation and application. */
 void generate_legal_moves(const Position* pos, MoveList* list);
+void generate_captures(const Position* pos, MoveList* list);
+void generate_evasions(const Position* pos, MoveList* list);
 bool engine_apply_move(Position* pos, Move move);
 bool engine_make_move(Position* pos, Move move);
+bool engine_is_move_legal(const Position* pos, Move move);
+
+/* In-place make/unmake for legal moves (no validation); undo must come from the make call. */
+bool engine_make_move_fast(Position* pos, Move move, MoveUndo* undo);
+void engine_unmake_move(Position* pos, Move move, const MoveUndo* undo);
+void engine_make_null_move(Position* pos, MoveUndo* undo);
+void engine_unmake_null_move(Position* pos, const MoveUndo* undo);
 
 /* Evaluation and search entry points. */
 int evaluate_position(const Position* pos);
+void engine_search(Engine* engine, const Position* pos, const SearchLimits* limits, SearchResult* out_result);
+/* engine_search on the default instance. */
 void search_best_move(const Position* pos, const SearchLimits* limits, SearchResult* out_result);
 
+/*
+ * Asynchronous search on the shared thread pool, one at a time per handle. search_stop is safe
+ * from any thread and makes the search return within a few nodes; search_wait collects it and
+ * yields the result (best move of the last completed depth when stopped), after which the
+ * handle can start again. search_is_running turns false once a result is ready to collect.
+ */
+typedef struct SearchHandle SearchHandle;
+
+/* Background searches run on `engine` (NULL: the default instance), which must outlive the handle. */
+SearchHandle* search_handle_create_for(Engine* engine);
+SearchHandle* search_handle_create(void);
+/* Stops and joins any search still running, then frees the handle. */
+void search_handle_destroy(SearchHandle* handle);
+bool search_start(SearchHandle* handle, const Position* pos, const SearchLimits* limits);
+/*
+ * Pondering: searches `pos` (the position after the expected reply) with no time limit until
+ * search_ponderhit, after which the normal max_time_ms applies, counted from the ponder start.
+ * On a miss, search_stop + search_wait discard it.
+ */
+bool search_start_ponder(SearchHandle* handle, const Position* pos, const SearchLimits* limits);
+void search_ponderhit(SearchHandle* handle);
+void search_stop(SearchHandle* handle);
+bool search_is_running(SearchHandle* handle);
+/* Returns false when no search was started since the last wait. */
+bool search_wait(SearchHandle* handle, SearchResult* out_result);
+
 /* UCI coordinate helpers (e.g. e2e4, e7e8q). */
 void move_to_uci(Move move, char out[6]);
 bool move_from_uci(const char* text, Move* out_move);
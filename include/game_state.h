@@ -63,6 +63,7 @@ typedef struct ChessApp {
 
     SearchLimits ai_limits;
     int ai_difficulty;
+    bool ai_ponder; /* Search the expected reply on the human's time (set from difficulty). */
     SearchResult last_ai_result;
 
     Profile profile;
@@ -0,0 +1,69 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+/*
+ * Work-stealing scheduler for fine-grained parallel jobs (perft subtrees, EPD batches,
+ * game analysis). Each worker owns a lock-free Chase-Lev deque: it pushes and pops its own
+ * tasks LIFO at the bottom while idle workers steal FIFO from the top of a random victim.
+ * Threads outside the scheduler spawn into a shared submission deque. A thread waiting on
+ * a TaskGroup keeps running and stealing tasks until the group is done, so tasks may spawn
+ * and wait on subtasks to any depth.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Per-deque capacity (power of two); a spawn into a full deque runs inline instead. */
+#define TASK_DEQUE_CAPACITY 4096
+
+typedef struct TaskScheduler TaskScheduler;
+typedef void (*TaskFn)(TaskScheduler* scheduler, void* arg);
+
+/* Completion counter for a batch of spawned tasks. */
+typedef struct TaskGroup {
+    atomic_int pending;
+} TaskGroup;
+
+/* Caller-owned task storage; it must stay valid until its group has been waited. */
+typedef struct Task {
+    TaskFn fn;
+    void* arg;
+    TaskGroup* group;
+} Task;
+
+/* Totals since creation (or the last reset). A steal attempt fails when the victim is empty or another thief wins. */
+typedef struct TaskSchedulerStats {
+    uint64_t executed;
+    uint64_t steals;
+    uint64_t steal_attempts;
+    uint64_t inline_runs;
+} TaskSchedulerStats;
+
+/*
+ * Starts worker_count ChessThread workers. With 0 workers every task runs on the thread
+ * waiting in task_group_wait. NULL on failure.
+ */
+TaskScheduler* task_scheduler_create(int worker_count);
+/* Joins the workers; every group must have been waited first. */
+void task_scheduler_destroy(TaskScheduler* scheduler);
+int task_scheduler_size(const TaskScheduler* scheduler);
+
+void task_group_init(TaskGroup* group);
+/* Queues fn(arg) in group; if the deque is full the task runs immediately on the caller. */
+void task_spawn(TaskScheduler* scheduler, TaskGroup* group, Task* task, TaskFn fn, void* arg);
+/* Runs or steals queued tasks until every task of the group has finished. */
+void task_group_wait(TaskScheduler* scheduler, TaskGroup* group);
+
+void task_scheduler_stats(TaskScheduler* scheduler, TaskSchedulerStats* out_stats);
+void task_scheduler_reset_stats(TaskScheduler* scheduler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,5 +12,64 @@ typedef struct ChessThread {
 
 bool chess_thread_create(ChessThread* thread, ChessThreadStart start, void* arg);
 void chess_thread_join(ChessThread* thread);
+/* Number of online logical CPUs (at least 1). */
+int chess_cpu_count(void);
+/* Blocks the calling thread for roughly `ms` milliseconds. */
+void chess_sleep_ms(int ms);
+/* Gives up the rest of the calling thread's time slice. */
+void chess_thread_yield(void);
+/* Pins the calling thread to one logical CPU; false where unsupported or on failure. */
+bool chess_thread_pin_current(int cpu);
+
+/* Mutex and condition variable; like ChessThread the OS object lives behind `handle`. */
+typedef struct ChessMutex {
+    void* handle;
+} ChessMutex;
+
+typedef struct ChessCond {
+    void* handle;
+} ChessCond;
+
+bool chess_mutex_init(ChessMutex* mutex);
+void chess_mutex_destroy(ChessMutex* mutex);
+void chess_mutex_lock(ChessMutex* mutex);
+void chess_mutex_unlock(ChessMutex* mutex);
+bool chess_cond_init(ChessCond* cond);
+void chess_cond_destroy(ChessCond* cond);
+/* Atomically releases `mutex` and sleeps; may wake spuriously, so re-check the predicate. */
+void chess_cond_wait(ChessCond* cond, ChessMutex* mutex);
+void chess_cond_signal(ChessCond* cond);
+void chess_cond_broadcast(ChessCond* cond);
+
+/*
+ * Fixed-size pool of persistent worker threads fed from one FIFO task queue. Each
+ * submitted task yields a future; chess_future_wait runs a task that is still queued on the
+ * waiting thread, so tasks may wait on tasks they submitted without deadlocking a full pool.
+ */
+typedef struct ChessThreadPool ChessThreadPool;
+typedef struct ChessFuture ChessFuture;
+
+/* pin_threads pins worker i to CPU i % chess_cpu_count(). NULL on failure. */
+ChessThreadPool* chess_pool_create(int thread_count, bool pin_threads);
+/* Finishes every queued task, then joins the workers; outstanding futures must be waited first. */
+void chess_pool_destroy(ChessThreadPool* pool);
+int chess_pool_size(const ChessThreadPool* pool);
+/* NULL when the future cannot be allocated; the task is then not queued. */
+ChessFuture* chess_pool_submit(ChessThreadPool* pool, ChessThreadStart start, void* arg);
+/* Like chess_pool_submit, but NULL unless an idle worker will pick the task up at once. */
+ChessFuture* chess_pool_submit_if_idle(ChessThreadPool* pool, ChessThreadStart start, void* arg);
+bool chess_future_is_ready(ChessFuture* future);
+/* Blocks until the task has run, frees the future and returns the task's return value. */
+void* chess_future_wait(ChessFuture* future);
+
+/*
+ * Process-wide pool used by the engine and the GUI, created on first use with
+ * max(chess_cpu_count(), CHESS_POOL_MIN_THREADS) workers so that a few long-running jobs
+ * (a pondering search, a network request) cannot starve each other on small machines.
+ */
+#define CHESS_POOL_MIN_THREADS 4
+ChessThreadPool* chess_pool_shared(void);
+/* Destroys the shared pool (at exit, once no task is outstanding); a later call recreates it. */
+void chess_pool_shutdown_shared(void);
 
 #endif
@@ -13,6 +13,7 @@
 /* Board and protocol limits. */
 #define BOARD_SQUARES 64
 #define MAX_MOVES 256
+#define MAILBOX_EMPTY 0xFFU
 #define MOVE_LOG_MAX 512
 #define INVITE_CODE_LEN 10
 #define PLAYER_NAME_MAX 31
@@ -86,13 +87,12 @@ typedef enum MoveFlags {
     MOVE_FLAG_PROMOTION = 1 << 5
 } MoveFlags;
 
-/* Compact move structure; squares are 0..63. */
+/* Public move structure (API, GUI and network boundary); squares are 0..63. */
 typedef struct Move {
     uint8_t from;
     uint8_t to;
     uint8_t promotion;
     uint8_t flags;
-    int16_t score;
 } Move;
 
 /* Flat move list with fixed capacity for speed and allocation simplicity. */
@@ -115,13 +115,39 @@ typedef struct Position {
     uint16_t halfmove_clock;
     uint16_t fullmove_number;
     uint64_t zobrist_key;
+    /* Zobrist hash of pawns only (pawn hash index); maintained incrementally like zobrist_key. */
+    uint64_t pawn_key;
+    /* Running material+PST totals (White minus Black) and raw game phase, updated by make-move. */
+    int32_t psq_mg;
+    int32_t psq_eg;
+    int16_t phase;
+    /* Square-indexed mirror of pieces: (side << 3) | piece, or MAILBOX_EMPTY. */
+    uint8_t board[BOARD_SQUARES];
 } Position;
 
+/* Compact per-ply undo record for in-place make/unmake in search and perft. */
+typedef struct MoveUndo {
+    uint64_t zobrist_key;
+    uint64_t pawn_key;
+    int32_t psq_mg;
+    int32_t psq_eg;
+    int16_t phase;
+    uint16_t halfmove_clock;
+    int8_t en_passant_square;
+    uint8_t castling_rights;
+    uint8_t captured_piece;
+} MoveUndo;
+
 /* Search limits configured by UI and consumed by engine search. */
 typedef struct SearchLimits {
     int depth;
-    int max_time_ms;
+    int max_time_ms; /* Fixed per-move time cap; <= 0 for none. */
     int randomness;
+    int threads; /* Lazy SMP search threads; <= 1 searches on the calling thread only. */
+    int time_left_ms; /* Clock of the side to move; <= 0 when playing without a clock. */
+    int increment_ms; /* Added to that clock after each move. */
+    int moves_to_go; /* Moves until the next time control; <= 0 for sudden death. */
+    uint64_t max_nodes; /* Node budget of the main search thread; 0 for none. */
 } SearchLimits;
 
 /* Search output payload for GUI and logging. */
@@ -130,6 +156,14 @@ typedef struct SearchResult {
     int score;
     int depth_reached;
     uint64_t nodes;
+    uint64_t qsearch_nodes; /* Subset of `nodes` spent in quiescence. */
+    uint64_t pawn_hash_probes;
+    uint64_t pawn_hash_hits;
+    uint64_t eval_cache_probes;
+    uint64_t eval_cache_hits;
+    int helper_threads; /* Lazy SMP helpers that actually searched; below threads - 1 when the pool was busy. */
+    Move ponder_move; /* Expected reply to best_move, valid when has_ponder_move. */
+    bool has_ponder_move;
 } SearchResult;
 
 /* Persisted user profile (local file-backed storage). */
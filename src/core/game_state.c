@@ -19,6 +19,7 @@
 
 #include "audio.h"
 #include "secure_io.h"
+#include "threading.h"
 
 /* Default legacy filenames used before secure storage migration. */
 static const char* LEGACY_SETTINGS_PATH = "settings.dat";
@@ -30,11 +31,22 @@ static char g_online_sessions_path[STORAGE_PATH_MAX] = "online_matches.dat";
 static bool g_storage_paths_ready = false;
 
 #define ONLINE_SESSIONS_MAGIC 0x43484F4EU /* CHON */
-#define ONLINE_SESSIONS_VERSION 1U
+#define ONLINE_SESSIONS_VERSION 4U
 #define CASTLE_SECOND_SFX_DELAY_SECONDS 0.11f
 #define AI_MIN_DEPTH 2
 #define AI_MAX_DEPTH 18
 #define AI_MAX_TIME_MS 25000
+#define AI_MAX_THREADS 8
+/* Node budget at 0%; it doubles every AI_NODE_DOUBLING_PERCENT points up to 99%. */
+#define AI_MIN_NODES 500ULL
+#define AI_NODE_DOUBLING_PERCENT 7
+/* Below this level the search is single-threaded, so a node budget plays identically everywhere. */
+#define AI_SMP_MIN_DIFFICULTY 60
+/*
+ * Pondering keeps the node budget, so it only shortens the reply; below about half a second
+ * of search (this many nodes) there is nothing worth saving. From 77% up, and at 100%.
+ */
+#define AI_PONDER_MIN_NODES 1000000ULL
 
 typedef struct PersistedOnlineHeader {
     uint32_t magic;
@@ -592,12 +604,33 @@ static void sync_app_from_match(ChessApp* app, const OnlineMatch* match, bool op
     }
 }
 
-/* Maps one user-facing AI difficulty percent into internal search limits. */
+/* Node budget for one move: exponential in difficulty, linearly interpolated between doublings; 0 at 100%. */
+static uint64_t ai_node_budget(int difficulty) {
+    int doublings;
+    int remainder;
+    uint64_t nodes;
+
+    if (difficulty >= 100) {
+        return 0ULL;
+    }
+
+    doublings = difficulty / AI_NODE_DOUBLING_PERCENT;
+    remainder = difficulty % AI_NODE_DOUBLING_PERCENT;
+    nodes = AI_MIN_NODES << doublings;
+    return nodes + (nodes * (uint64_t)remainder) / AI_NODE_DOUBLING_PERCENT;
+}
+
+/*
+ * Maps one user-facing AI difficulty percent into internal search limits. Strength comes
+ * mainly from the node budget, so weak levels cost little CPU and play the same on any
+ * machine; depth and time remain as ceilings, and 100% searches on time alone.
+ */
 void app_set_ai_difficulty(ChessApp* app, int difficulty_percent) {
     int difficulty;
     int depth_span;
     int depth;
     int max_time_ms;
+    int threads;
 
     if (app == NULL) {
         return;
@@ -629,9 +662,24 @@ void app_set_ai_difficulty(ChessApp* app, int difficulty_percent) {
         max_time_ms = AI_MAX_TIME_MS;
     }
 
+    /* Lazy SMP helpers; leave one core for the UI thread. */
+    threads = 1;
+    if (difficulty >= AI_SMP_MIN_DIFFICULTY) {
+        threads = chess_cpu_count() - 1;
+        if (threads < 1) {
+            threads = 1;
+        }
+        if (threads > AI_MAX_THREADS) {
+            threads = AI_MAX_THREADS;
+        }
+    }
+
     app->ai_limits.depth = depth;
     app->ai_limits.max_time_ms = max_time_ms;
     app->ai_limits.randomness = 0;
+    app->ai_limits.threads = threads;
+    app->ai_limits.max_nodes = ai_node_budget(difficulty);
+    app->ai_ponder = app->ai_limits.max_nodes == 0ULL || app->ai_limits.max_nodes >= AI_PONDER_MIN_NODES;
 }
 
 /* Parses persisted settings key/value pairs into app state. */
@@ -977,6 +1025,7 @@ static void load_online_sessions_internal(ChessApp* app) {
         match->started_epoch = rec->started_epoch;
 
         match->position = rec->position;
+        position_refresh_occupancy(&match->position);
         match->last_move_from = rec->last_move_from;
         match->last_move_to = rec->last_move_to;
         match->move_log_count = rec->move_log_count;
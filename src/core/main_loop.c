@@ -151,72 +151,71 @@ static void try_set_window_icon(void) {
     }
 }
 
-/* Background worker state used to keep AI search off the render thread. */
+/*
+ * Background AI search kept off the render thread; the engine's search handle runs it on
+ * the shared pool.
+ * While `pondering`, the search runs on position_key (expected human reply already played)
+ * and ponder_from_key is the position the human is still thinking about.
+ */
 typedef struct AIWorker {
-    Position position;
-    SearchLimits limits;
-    SearchResult result;
-    atomic_bool running;
-    atomic_bool has_result;
+    SearchHandle* search;
+    uint64_t position_key;
+    uint64_t ponder_from_key;
     bool thread_active;
-    ChessThread handle;
+    bool pondering;
 } AIWorker;
 
-/* Worker thread entry point: run search and publish result atomically. */
-static void* ai_worker_thread(void* data) {
-    AIWorker* worker = (AIWorker*)data;
-
-    search_best_move(&worker->position, &worker->limits, &worker->result);
-    atomic_store(&worker->has_result, true);
-    atomic_store(&worker->running, false);
-
-    return NULL;
-}
-
 /* Initializes worker runtime state. */
 static void ai_worker_init(AIWorker* worker) {
     memset(worker, 0, sizeof(*worker));
-    atomic_init(&worker->running, false);
-    atomic_init(&worker->has_result, false);
+    worker->search = search_handle_create();
 }
 
 /* Starts asynchronous AI search for a copied position snapshot. */
 static bool ai_worker_start(AIWorker* worker, const Position* position, const SearchLimits* limits) {
-    if (worker->thread_active) {
+    if (worker->thread_active || !search_start(worker->search, position, limits)) {
         return false;
     }
 
-    worker->position = *position;
-    worker->limits = *limits;
-    memset(&worker->result, 0, sizeof(worker->result));
+    worker->position_key = position->zobrist_key;
+    worker->thread_active = true;
+    worker->pondering = false;
+    return true;
+}
 
-    atomic_store(&worker->running, true);
-    atomic_store(&worker->has_result, false);
+/* Searches the position after the expected human reply while the human is still thinking. */
+static bool ai_worker_start_ponder(AIWorker* worker, const Position* position, Move expected, const SearchLimits* limits) {
+    Position next = *position;
 
-    if (!chess_thread_create(&worker->handle, ai_worker_thread, worker)) {
-        atomic_store(&worker->running, false);
+    if (worker->thread_active || !engine_make_move(&next, expected) ||
+        !search_start_ponder(worker->search, &next, limits)) {
         return false;
     }
 
+    worker->ponder_from_key = position->zobrist_key;
+    worker->position_key = next.zobrist_key;
     worker->thread_active = true;
+    worker->pondering = true;
     return true;
 }
 
-/* Joins running AI thread and marks worker as idle. */
-static void ai_worker_join(AIWorker* worker) {
+/* Aborts any search in flight and drops its result; the worker can start again immediately. */
+static void ai_worker_cancel(AIWorker* worker) {
     if (!worker->thread_active) {
         return;
     }
 
-    chess_thread_join(&worker->handle);
+    search_stop(worker->search);
+    (void)search_wait(worker->search, NULL);
     worker->thread_active = false;
+    worker->pondering = false;
 }
 
-/* Ensures no worker thread is left alive on shutdown. */
+/* Ensures no search is left running on shutdown. */
 static void ai_worker_shutdown(AIWorker* worker) {
-    if (worker->thread_active) {
-        ai_worker_join(worker);
-    }
+    ai_worker_cancel(worker);
+    search_handle_destroy(worker->search);
+    worker->search = NULL;
 }
 
 /* Background worker for online connectivity checks/handshakes without UI stalls. */
@@ -233,7 +232,7 @@ typedef struct OnlineWorker {
     atomic_bool running;
     atomic_bool has_result;
     bool thread_active;
-    ChessThread handle;
+    ChessFuture* job;
 } OnlineWorker;
 
 /* Copies one robust network error string into worker result buffer. */
@@ -362,7 +361,8 @@ static bool online_worker_start(OnlineWorker* worker, const ChessApp* app) {
     atomic_store(&worker->running, true);
     atomic_store(&worker->has_result, false);
 
-    if (!chess_thread_create(&worker->handle, online_worker_thread, worker)) {
+    worker->job = chess_pool_submit(chess_pool_shared(), online_worker_thread, worker);
+    if (worker->job == NULL) {
         atomic_store(&worker->running, false);
         return false;
     }
@@ -371,7 +371,7 @@ static bool online_worker_start(OnlineWorker* worker, const ChessApp* app) {
     return true;
 }
 
-/* Joins online worker thread if it is finished. */
+/* Collects the online job if it has finished. */
 static bool online_worker_try_join(OnlineWorker* worker) {
     if (worker == NULL || !worker->thread_active) {
         return false;
@@ -380,7 +380,8 @@ static bool online_worker_try_join(OnlineWorker* worker) {
         return false;
     }
 
-    chess_thread_join(&worker->handle);
+    (void)chess_future_wait(worker->job);
+    worker->job = NULL;
     worker->thread_active = false;
     return true;
 }
@@ -392,7 +393,8 @@ static void online_worker_shutdown(OnlineWorker* worker) {
     }
 
     if (worker->thread_active) {
-        chess_thread_join(&worker->handle);
+        (void)chess_future_wait(worker->job);
+        worker->job = NULL;
         worker->thread_active = false;
     }
 
@@ -521,31 +523,68 @@ static void maybe_process_online_actions(ChessApp* app, OnlineWorker* worker) {
     clear_online_loading(app);
 }
 
-/* Drives AI turn flow in single-player mode. */
+/* The difficulty's limits plus the turn clock when one runs (a ponder search gets the AI's next full turn). */
+static SearchLimits ai_move_limits(const ChessApp* app) {
+    SearchLimits limits = app->ai_limits;
+
+    if (app->turn_timer_enabled && app->turn_time_seconds >= 10) {
+        bool ai_turn = app->position.side_to_move != app->human_side;
+        float remaining = ai_turn ? app->turn_time_remaining : (float)app->turn_time_seconds;
+
+        limits.time_left_ms = (int)(remaining * 1000.0f);
+        limits.increment_ms = 0;
+        limits.moves_to_go = 1;
+    }
+    return limits;
+}
+
+/* Drives AI turn flow in single-player mode, pondering on the human's time when enabled. */
 static void maybe_process_ai_turn(ChessApp* app, AIWorker* worker) {
     if (app->mode != MODE_SINGLE || app->screen != SCREEN_PLAY || app->game_over) {
-        if (worker->thread_active && !atomic_load(&worker->running)) {
-            ai_worker_join(worker);
-        }
+        ai_worker_cancel(worker);
         app->ai_thinking = false;
         return;
     }
 
+    if (worker->pondering) {
+        if (app->position.zobrist_key == worker->position_key) {
+            /* Ponder hit: keep the search; its time limit applies from now on. */
+            search_ponderhit(worker->search);
+            worker->pondering = false;
+        } else if (app->position.zobrist_key != worker->ponder_from_key) {
+            /* Ponder miss (or undo/new game): the speculative search is useless. */
+            ai_worker_cancel(worker);
+        }
+    }
+
+    /* Undo or a new game replaced the position being searched; its move is useless now. */
+    if (worker->thread_active && !worker->pondering && worker->position_key != app->position.zobrist_key) {
+        ai_worker_cancel(worker);
+    }
+
     {
         bool ai_turn = app->position.side_to_move != app->human_side;
         if (ai_turn && !worker->thread_active) {
-            ai_worker_start(worker, &app->position, &app->ai_limits);
+            SearchLimits limits = ai_move_limits(app);
+
+            ai_worker_start(worker, &app->position, &limits);
         }
     }
 
-    app->ai_thinking = worker->thread_active && atomic_load(&worker->running);
+    app->ai_thinking = worker->thread_active && !worker->pondering && search_is_running(worker->search);
+
+    if (worker->thread_active && !worker->pondering && !search_is_running(worker->search)) {
+        SearchResult result;
 
-    if (worker->thread_active && !atomic_load(&worker->running)) {
-        ai_worker_join(worker);
+        worker->thread_active = false;
+        if (search_wait(worker->search, &result)) {
+            app->last_ai_result = result;
+            app_apply_move(app, result.best_move);
+            if (app->ai_ponder && result.has_ponder_move && !app->game_over) {
+                SearchLimits limits = ai_move_limits(app);
 
-        if (atomic_load(&worker->has_result)) {
-            app->last_ai_result = worker->result;
-            app_apply_move(app, worker->result.best_move);
+                ai_worker_start_ponder(worker, &app->position, result.ponder_move, &limits);
+            }
         }
 
         app->ai_thinking = false;
@@ -781,7 +820,6 @@ static void maybe_process_network(ChessApp* app) {
                     move.to = packet.to;
                     move.promotion = packet.promotion;
                     move.flags = packet.flags;
-                    move.score = 0;
 
                     if (index == app->current_online_match &&
                         app->mode == MODE_ONLINE &&
@@ -934,6 +972,7 @@ int run_main_loop(void) {
 
     ai_worker_shutdown(&worker);
     online_worker_shutdown(&online_worker);
+    chess_pool_shutdown_shared();
     app_save_settings(&app);
     app_online_store_current_match(&app);
     app_online_save_sessions(&app);
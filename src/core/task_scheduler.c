@@ -0,0 +1,373 @@
+#include "task_scheduler.h"
+#include "threading.h"
+
+#include <stdlib.h>
+
+#define TASK_DEQUE_MASK (TASK_DEQUE_CAPACITY - 1)
+/* Failed steal sweeps an idle worker spins through before sleeping on the condvar. */
+#define TASK_IDLE_SPINS 32
+#define TASK_CACHE_LINE 64
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TASK_THREAD_LOCAL __declspec(thread)
+#else
+#define TASK_THREAD_LOCAL _Thread_local
+#endif
+
+/*
+ * Chase-Lev deque (Le et al., "Correct and Efficient Work-Stealing for Weak Memory
+ * Models"). The owner pushes/pops at `bottom`; thieves CAS `top`. Indices only grow.
+ * The paper's seq_cst fences are folded into seq_cst accesses of `bottom` and `top`,
+ * which give the same store-load ordering and which ThreadSanitizer can check.
+ */
+typedef struct TaskDeque {
+    _Alignas(TASK_CACHE_LINE) _Atomic int64_t top;
+    _Alignas(TASK_CACHE_LINE) _Atomic int64_t bottom;
+    _Alignas(TASK_CACHE_LINE) _Atomic(Task*) buffer[TASK_DEQUE_CAPACITY];
+} TaskDeque;
+
+/* Slot 0 is the shared submission deque for outside threads; its owner side is serialized by submit_lock. */
+typedef struct TaskWorker {
+    TaskDeque deque;
+    TaskScheduler* scheduler;
+    _Alignas(TASK_CACHE_LINE) _Atomic uint64_t executed;
+    _Atomic uint64_t steals;
+    _Atomic uint64_t steal_attempts;
+    _Atomic uint64_t inline_runs;
+    ChessThread thread;
+} TaskWorker;
+
+struct TaskScheduler {
+    void* workers_block;
+    TaskWorker* workers; /* workers_block rounded up to a cache line. */
+    int worker_count; /* Threads; workers[] holds one more (the submission slot). */
+    ChessMutex submit_lock;
+    ChessMutex idle_lock;
+    ChessCond idle_cond;
+    _Atomic int64_t queued;
+    atomic_int sleepers;
+    atomic_bool stopping;
+};
+
+static TASK_THREAD_LOCAL TaskWorker* t_worker = NULL;
+static TASK_THREAD_LOCAL uint64_t t_rng = 0U;
+
+static bool deque_push(TaskDeque* deque, Task* task) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+
+    if (bottom - top >= TASK_DEQUE_CAPACITY) {
+        return false;
+    }
+    atomic_store_explicit(&deque->buffer[bottom & TASK_DEQUE_MASK], task, memory_order_relaxed);
+    /* Release store (the paper's release fence + relaxed store) publishes the task to thieves. */
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+    return true;
+}
+
+static Task* deque_pop(TaskDeque* deque) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    int64_t top;
+    Task* task = NULL;
+
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_seq_cst);
+    top = atomic_load_explicit(&deque->top, memory_order_seq_cst);
+
+    if (top <= bottom) {
+        task = atomic_load_explicit(&deque->buffer[bottom & TASK_DEQUE_MASK], memory_order_relaxed);
+        if (top == bottom) {
+            /* Last element: race the thieves for it. */
+            if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                         memory_order_seq_cst, memory_order_relaxed)) {
+                task = NULL;
+            }
+            atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+static Task* deque_steal(TaskDeque* deque) {
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_seq_cst);
+    Task* task;
+
+    if (top >= bottom) {
+        return NULL;
+    }
+
+    task = atomic_load_explicit(&deque->buffer[top & TASK_DEQUE_MASK], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL;
+    }
+    return task;
+}
+
+/* The calling thread's deque slot: its own worker, or the shared submission slot. */
+static TaskWorker* current_worker(TaskScheduler* scheduler) {
+    TaskWorker* worker = t_worker;
+
+    return (worker != NULL && worker->scheduler == scheduler) ? worker : &scheduler->workers[0];
+}
+
+static Task* pop_own(TaskScheduler* scheduler, TaskWorker* self) {
+    Task* task;
+
+    if (self != &scheduler->workers[0]) {
+        return deque_pop(&self->deque);
+    }
+    chess_mutex_lock(&scheduler->submit_lock);
+    task = deque_pop(&self->deque);
+    chess_mutex_unlock(&scheduler->submit_lock);
+    return task;
+}
+
+/* Per-thread xorshift64 for victim selection, seeded from the thread's stack address. */
+static uint64_t next_random(void) {
+    uint64_t x = t_rng;
+
+    if (x == 0U) {
+        x = ((uint64_t)(uintptr_t)&x * 0x9E3779B97F4A7C15ULL) | 1U;
+    }
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    t_rng = x;
+    return x;
+}
+
+/* Own deque first, then one sweep over every other deque from a random start. */
+static Task* find_task(TaskScheduler* scheduler, TaskWorker* self) {
+    int slot_count = scheduler->worker_count + 1;
+    int start;
+    Task* task = pop_own(scheduler, self);
+
+    if (task != NULL) {
+        atomic_fetch_sub(&scheduler->queued, 1);
+        return task;
+    }
+
+    start = (int)(next_random() % (uint64_t)slot_count);
+    for (int i = 0; i < slot_count; ++i) {
+        TaskWorker* victim = &scheduler->workers[(start + i) % slot_count];
+
+        if (victim == self) {
+            continue;
+        }
+        atomic_fetch_add_explicit(&self->steal_attempts, 1U, memory_order_relaxed);
+        task = deque_steal(&victim->deque);
+        if (task != NULL) {
+            atomic_fetch_add_explicit(&self->steals, 1U, memory_order_relaxed);
+            atomic_fetch_sub(&scheduler->queued, 1);
+            return task;
+        }
+    }
+    return NULL;
+}
+
+static void run_task(TaskScheduler* scheduler, TaskWorker* self, Task* task) {
+    TaskGroup* group = task->group;
+
+    task->fn(scheduler, task->arg);
+    atomic_fetch_add_explicit(&self->executed, 1U, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&group->pending, 1, memory_order_release);
+}
+
+/* Sleeps until work is queued or the scheduler stops; sleepers/queued pair up Dekker-style with task_spawn. */
+static void idle_wait(TaskScheduler* scheduler) {
+    chess_mutex_lock(&scheduler->idle_lock);
+    atomic_fetch_add(&scheduler->sleepers, 1);
+    while (atomic_load(&scheduler->queued) <= 0 && !atomic_load(&scheduler->stopping)) {
+        chess_cond_wait(&scheduler->idle_cond, &scheduler->idle_lock);
+    }
+    atomic_fetch_sub(&scheduler->sleepers, 1);
+    chess_mutex_unlock(&scheduler->idle_lock);
+}
+
+static void* task_worker_main(void* arg) {
+    TaskWorker* self = (TaskWorker*)arg;
+    TaskScheduler* scheduler = self->scheduler;
+    int idle_spins = 0;
+
+    t_worker = self;
+    while (!atomic_load_explicit(&scheduler->stopping, memory_order_relaxed)) {
+        Task* task = find_task(scheduler, self);
+
+        if (task != NULL) {
+            run_task(scheduler, self, task);
+            idle_spins = 0;
+        } else if (++idle_spins < TASK_IDLE_SPINS) {
+            chess_thread_yield();
+        } else {
+            idle_wait(scheduler);
+            idle_spins = 0;
+        }
+    }
+    t_worker = NULL;
+    return NULL;
+}
+
+TaskScheduler* task_scheduler_create(int worker_count) {
+    TaskScheduler* scheduler;
+    int started = 0;
+
+    if (worker_count < 0) {
+        worker_count = 0;
+    }
+
+    scheduler = (TaskScheduler*)calloc(1U, sizeof(*scheduler));
+    if (scheduler == NULL) {
+        return NULL;
+    }
+    scheduler->workers_block = calloc(1U, ((size_t)worker_count + 1U) * sizeof(TaskWorker) + TASK_CACHE_LINE);
+    if (scheduler->workers_block == NULL || !chess_mutex_init(&scheduler->submit_lock)) {
+        free(scheduler->workers_block);
+        free(scheduler);
+        return NULL;
+    }
+    if (!chess_mutex_init(&scheduler->idle_lock)) {
+        chess_mutex_destroy(&scheduler->submit_lock);
+        free(scheduler->workers_block);
+        free(scheduler);
+        return NULL;
+    }
+    if (!chess_cond_init(&scheduler->idle_cond)) {
+        chess_mutex_destroy(&scheduler->idle_lock);
+        chess_mutex_destroy(&scheduler->submit_lock);
+        free(scheduler->workers_block);
+        free(scheduler);
+        return NULL;
+    }
+    scheduler->workers = (TaskWorker*)(((uintptr_t)scheduler->workers_block + (TASK_CACHE_LINE - 1)) &
+                                       ~(uintptr_t)(TASK_CACHE_LINE - 1));
+    atomic_init(&scheduler->queued, 0);
+    atomic_init(&scheduler->sleepers, 0);
+    atomic_init(&scheduler->stopping, false);
+
+    for (int i = 0; i <= worker_count; ++i) {
+        TaskWorker* worker = &scheduler->workers[i];
+
+        atomic_init(&worker->deque.top, 0);
+        atomic_init(&worker->deque.bottom, 0);
+        worker->scheduler = scheduler;
+        atomic_init(&worker->executed, 0U);
+        atomic_init(&worker->steals, 0U);
+        atomic_init(&worker->steal_attempts, 0U);
+        atomic_init(&worker->inline_runs, 0U);
+    }
+
+    /* Workers only ever look at slots below worker_count + 1, so a failed start just leaves an empty deque. */
+    scheduler->worker_count = worker_count;
+    for (int i = 1; i <= worker_count; ++i) {
+        if (chess_thread_create(&scheduler->workers[i].thread, task_worker_main, &scheduler->workers[i])) {
+            started++;
+        }
+    }
+    if (worker_count > 0 && started == 0) {
+        task_scheduler_destroy(scheduler);
+        return NULL;
+    }
+    return scheduler;
+}
+
+void task_scheduler_destroy(TaskScheduler* scheduler) {
+    if (scheduler == NULL) {
+        return;
+    }
+
+    chess_mutex_lock(&scheduler->idle_lock);
+    atomic_store(&scheduler->stopping, true);
+    chess_cond_broadcast(&scheduler->idle_cond);
+    chess_mutex_unlock(&scheduler->idle_lock);
+
+    for (int i = 1; i <= scheduler->worker_count; ++i) {
+        chess_thread_join(&scheduler->workers[i].thread);
+    }
+
+    chess_cond_destroy(&scheduler->idle_cond);
+    chess_mutex_destroy(&scheduler->idle_lock);
+    chess_mutex_destroy(&scheduler->submit_lock);
+    free(scheduler->workers_block);
+    free(scheduler);
+}
+
+int task_scheduler_size(const TaskScheduler* scheduler) {
+    return (scheduler != NULL) ? scheduler->worker_count : 0;
+}
+
+void task_group_init(TaskGroup* group) {
+    atomic_init(&group->pending, 0);
+}
+
+void task_spawn(TaskScheduler* scheduler, TaskGroup* group, Task* task, TaskFn fn, void* arg) {
+    TaskWorker* self = current_worker(scheduler);
+    bool pushed;
+
+    task->fn = fn;
+    task->arg = arg;
+    task->group = group;
+    atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+
+    if (self == &scheduler->workers[0]) {
+        chess_mutex_lock(&scheduler->submit_lock);
+        pushed = deque_push(&self->deque, task);
+        chess_mutex_unlock(&scheduler->submit_lock);
+    } else {
+        pushed = deque_push(&self->deque, task);
+    }
+
+    if (!pushed) {
+        atomic_fetch_add_explicit(&self->inline_runs, 1U, memory_order_relaxed);
+        run_task(scheduler, self, task);
+        return;
+    }
+
+    atomic_fetch_add(&scheduler->queued, 1);
+    if (atomic_load(&scheduler->sleepers) > 0) {
+        chess_mutex_lock(&scheduler->idle_lock);
+        chess_cond_signal(&scheduler->idle_cond);
+        chess_mutex_unlock(&scheduler->idle_lock);
+    }
+}
+
+void task_group_wait(TaskScheduler* scheduler, TaskGroup* group) {
+    TaskWorker* self = current_worker(scheduler);
+
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) > 0) {
+        Task* task = find_task(scheduler, self);
+
+        if (task != NULL) {
+            run_task(scheduler, self, task);
+        } else {
+            chess_thread_yield();
+        }
+    }
+}
+
+void task_scheduler_stats(TaskScheduler* scheduler, TaskSchedulerStats* out_stats) {
+    TaskSchedulerStats stats = {0U, 0U, 0U, 0U};
+
+    for (int i = 0; i <= scheduler->worker_count; ++i) {
+        TaskWorker* worker = &scheduler->workers[i];
+
+        stats.executed += atomic_load_explicit(&worker->executed, memory_order_relaxed);
+        stats.steals += atomic_load_explicit(&worker->steals, memory_order_relaxed);
+        stats.steal_attempts += atomic_load_explicit(&worker->steal_attempts, memory_order_relaxed);
+        stats.inline_runs += atomic_load_explicit(&worker->inline_runs, memory_order_relaxed);
+    }
+    *out_stats = stats;
+}
+
+void task_scheduler_reset_stats(TaskScheduler* scheduler) {
+    for (int i = 0; i <= scheduler->worker_count; ++i) {
+        TaskWorker* worker = &scheduler->workers[i];
+
+        atomic_store_explicit(&worker->executed, 0U, memory_order_relaxed);
+        atomic_store_explicit(&worker->steals, 0U, memory_order_relaxed);
+        atomic_store_explicit(&worker->steal_attempts, 0U, memory_order_relaxed);
+        atomic_store_explicit(&worker->inline_runs, 0U, memory_order_relaxed);
+    }
+}
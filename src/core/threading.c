@@ -1,5 +1,10 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "threading.h"
 
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <stdint.h>
 
@@ -70,9 +75,94 @@ void chess_thread_join(ChessThread* thread) {
     thread->active = false;
 }
 
+int chess_cpu_count(void) {
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0U) ? (int)info.dwNumberOfProcessors : 1;
+}
+
+void chess_sleep_ms(int ms) {
+    Sleep((DWORD)((ms > 0) ? ms : 0));
+}
+
+void chess_thread_yield(void) {
+    (void)SwitchToThread();
+}
+
+bool chess_thread_pin_current(int cpu) {
+    if (cpu < 0 || cpu >= (int)(sizeof(DWORD_PTR) * 8U)) {
+        return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1U << cpu) != 0U;
+}
+
+bool chess_mutex_init(ChessMutex* mutex) {
+    CRITICAL_SECTION* section = (CRITICAL_SECTION*)malloc(sizeof(*section));
+
+    if (section == NULL) {
+        return false;
+    }
+    InitializeCriticalSection(section);
+    mutex->handle = section;
+    return true;
+}
+
+void chess_mutex_destroy(ChessMutex* mutex) {
+    if (mutex == NULL || mutex->handle == NULL) {
+        return;
+    }
+    DeleteCriticalSection((CRITICAL_SECTION*)mutex->handle);
+    free(mutex->handle);
+    mutex->handle = NULL;
+}
+
+void chess_mutex_lock(ChessMutex* mutex) {
+    EnterCriticalSection((CRITICAL_SECTION*)mutex->handle);
+}
+
+void chess_mutex_unlock(ChessMutex* mutex) {
+    LeaveCriticalSection((CRITICAL_SECTION*)mutex->handle);
+}
+
+bool chess_cond_init(ChessCond* cond) {
+    CONDITION_VARIABLE* variable = (CONDITION_VARIABLE*)malloc(sizeof(*variable));
+
+    if (variable == NULL) {
+        return false;
+    }
+    InitializeConditionVariable(variable);
+    cond->handle = variable;
+    return true;
+}
+
+void chess_cond_destroy(ChessCond* cond) {
+    if (cond == NULL || cond->handle == NULL) {
+        return;
+    }
+    free(cond->handle);
+    cond->handle = NULL;
+}
+
+void chess_cond_wait(ChessCond* cond, ChessMutex* mutex) {
+    SleepConditionVariableCS((CONDITION_VARIABLE*)cond->handle, (CRITICAL_SECTION*)mutex->handle, INFINITE);
+}
+
+void chess_cond_signal(ChessCond* cond) {
+    WakeConditionVariable((CONDITION_VARIABLE*)cond->handle);
+}
+
+void chess_cond_broadcast(ChessCond* cond) {
+    WakeAllConditionVariable((CONDITION_VARIABLE*)cond->handle);
+}
+
 #else
 
+#include <errno.h>
 #include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
 
 bool chess_thread_create(ChessThread* thread, ChessThreadStart start, void* arg) {
     pthread_t* handle;
@@ -110,4 +200,388 @@ void chess_thread_join(ChessThread* thread) {
     thread->active = false;
 }
 
+int chess_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0L) ? (int)count : 1;
+}
+
+void chess_sleep_ms(int ms) {
+    struct timespec delay;
+
+    if (ms <= 0) {
+        return;
+    }
+    delay.tv_sec = ms / 1000;
+    delay.tv_nsec = (long)(ms % 1000) * 1000000L;
+    while (nanosleep(&delay, &delay) != 0 && errno == EINTR) {
+    }
+}
+
+void chess_thread_yield(void) {
+    (void)sched_yield();
+}
+
+bool chess_thread_pin_current(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
 #endif
+}
+
+bool chess_mutex_init(ChessMutex* mutex) {
+    pthread_mutex_t* handle = (pthread_mutex_t*)malloc(sizeof(*handle));
+
+    if (handle == NULL) {
+        return false;
+    }
+    if (pthread_mutex_init(handle, NULL) != 0) {
+        free(handle);
+        return false;
+    }
+    mutex->handle = handle;
+    return true;
+}
+
+void chess_mutex_destroy(ChessMutex* mutex) {
+    if (mutex == NULL || mutex->handle == NULL) {
+        return;
+    }
+    pthread_mutex_destroy((pthread_mutex_t*)mutex->handle);
+    free(mutex->handle);
+    mutex->handle = NULL;
+}
+
+void chess_mutex_lock(ChessMutex* mutex) {
+    pthread_mutex_lock((pthread_mutex_t*)mutex->handle);
+}
+
+void chess_mutex_unlock(ChessMutex* mutex) {
+    pthread_mutex_unlock((pthread_mutex_t*)mutex->handle);
+}
+
+bool chess_cond_init(ChessCond* cond) {
+    pthread_cond_t* handle = (pthread_cond_t*)malloc(sizeof(*handle));
+
+    if (handle == NULL) {
+        return false;
+    }
+    if (pthread_cond_init(handle, NULL) != 0) {
+        free(handle);
+        return false;
+    }
+    cond->handle = handle;
+    return true;
+}
+
+void chess_cond_destroy(ChessCond* cond) {
+    if (cond == NULL || cond->handle == NULL) {
+        return;
+    }
+    pthread_cond_destroy((pthread_cond_t*)cond->handle);
+    free(cond->handle);
+    cond->handle = NULL;
+}
+
+void chess_cond_wait(ChessCond* cond, ChessMutex* mutex) {
+    pthread_cond_wait((pthread_cond_t*)cond->handle, (pthread_mutex_t*)mutex->handle);
+}
+
+void chess_cond_signal(ChessCond* cond) {
+    pthread_cond_signal((pthread_cond_t*)cond->handle);
+}
+
+void chess_cond_broadcast(ChessCond* cond) {
+    pthread_cond_broadcast((pthread_cond_t*)cond->handle);
+}
+
+#endif
+
+typedef enum ChessFutureState {
+    FUTURE_QUEUED = 0,
+    FUTURE_RUNNING = 1,
+    FUTURE_DONE = 2
+} ChessFutureState;
+
+/* One submitted task; linked into the pool queue while FUTURE_QUEUED. */
+struct ChessFuture {
+    ChessThreadPool* pool;
+    ChessThreadStart start;
+    void* arg;
+    void* result;
+    ChessFutureState state;
+    ChessFuture* prev;
+    ChessFuture* next;
+};
+
+typedef struct ChessPoolWorker {
+    ChessThreadPool* pool;
+    int cpu;
+    ChessThread thread;
+} ChessPoolWorker;
+
+/* Queue, futures and `stopping` are guarded by `mutex`; `task_done` is broadcast per finished task. */
+struct ChessThreadPool {
+    ChessMutex mutex;
+    ChessCond task_ready;
+    ChessCond task_done;
+    ChessFuture* head;
+    ChessFuture* tail;
+    int queued_count;
+    int idle_count; /* Workers waiting for a task. */
+    bool stopping;
+    int thread_count;
+    ChessPoolWorker* workers;
+};
+
+static _Atomic(ChessThreadPool*) g_shared_pool = NULL;
+
+/* Unlinks a queued future; caller holds the pool mutex. */
+static void pool_unlink(ChessThreadPool* pool, ChessFuture* future) {
+    if (future->prev != NULL) {
+        future->prev->next = future->next;
+    } else {
+        pool->head = future->next;
+    }
+    if (future->next != NULL) {
+        future->next->prev = future->prev;
+    } else {
+        pool->tail = future->prev;
+    }
+    future->prev = NULL;
+    future->next = NULL;
+    pool->queued_count--;
+}
+
+/* Runs one dequeued task outside the lock and publishes its result; called with the mutex held. */
+static void pool_run_locked(ChessThreadPool* pool, ChessFuture* future) {
+    void* result;
+
+    future->state = FUTURE_RUNNING;
+    chess_mutex_unlock(&pool->mutex);
+    result = future->start(future->arg);
+    chess_mutex_lock(&pool->mutex);
+    future->result = result;
+    future->state = FUTURE_DONE;
+    chess_cond_broadcast(&pool->task_done);
+}
+
+static void* pool_worker_main(void* arg) {
+    ChessPoolWorker* worker = (ChessPoolWorker*)arg;
+    ChessThreadPool* pool = worker->pool;
+
+    if (worker->cpu >= 0) {
+        (void)chess_thread_pin_current(worker->cpu);
+    }
+
+    chess_mutex_lock(&pool->mutex);
+    for (;;) {
+        ChessFuture* future;
+
+        pool->idle_count++;
+        while (pool->head == NULL && !pool->stopping) {
+            chess_cond_wait(&pool->task_ready, &pool->mutex);
+        }
+        pool->idle_count--;
+        if (pool->head == NULL) {
+            break;
+        }
+        future = pool->head;
+        pool_unlink(pool, future);
+        pool_run_locked(pool, future);
+    }
+    chess_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+ChessThreadPool* chess_pool_create(int thread_count, bool pin_threads) {
+    ChessThreadPool* pool;
+    int cpu_count = chess_cpu_count();
+
+    if (thread_count < 1) {
+        thread_count = 1;
+    }
+
+    pool = (ChessThreadPool*)calloc(1U, sizeof(*pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->workers = (ChessPoolWorker*)calloc((size_t)thread_count, sizeof(*pool->workers));
+    if (pool->workers == NULL || !chess_mutex_init(&pool->mutex)) {
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    if (!chess_cond_init(&pool->task_ready)) {
+        chess_mutex_destroy(&pool->mutex);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    if (!chess_cond_init(&pool->task_done)) {
+        chess_cond_destroy(&pool->task_ready);
+        chess_mutex_destroy(&pool->mutex);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+
+    for (int i = 0; i < thread_count; ++i) {
+        ChessPoolWorker* worker = &pool->workers[pool->thread_count];
+
+        worker->pool = pool;
+        worker->cpu = pin_threads ? (i % cpu_count) : -1;
+        if (chess_thread_create(&worker->thread, pool_worker_main, worker)) {
+            pool->thread_count++;
+        }
+    }
+    if (pool->thread_count == 0) {
+        chess_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void chess_pool_destroy(ChessThreadPool* pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    chess_mutex_lock(&pool->mutex);
+    pool->stopping = true;
+    chess_cond_broadcast(&pool->task_ready);
+    chess_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->thread_count; ++i) {
+        chess_thread_join(&pool->workers[i].thread);
+    }
+
+    chess_cond_destroy(&pool->task_done);
+    chess_cond_destroy(&pool->task_ready);
+    chess_mutex_destroy(&pool->mutex);
+    free(pool->workers);
+    free(pool);
+}
+
+int chess_pool_size(const ChessThreadPool* pool) {
+    return (pool != NULL) ? pool->thread_count : 0;
+}
+
+/*
+ * Queues a task; with require_idle only when an idle worker is left over after every task
+ * already queued, so the task is known to start without waiting behind running jobs.
+ */
+static ChessFuture* pool_submit(ChessThreadPool* pool, ChessThreadStart start, void* arg, bool require_idle) {
+    ChessFuture* future;
+
+    if (pool == NULL || start == NULL) {
+        return NULL;
+    }
+    future = (ChessFuture*)calloc(1U, sizeof(*future));
+    if (future == NULL) {
+        return NULL;
+    }
+    future->pool = pool;
+    future->start = start;
+    future->arg = arg;
+    future->state = FUTURE_QUEUED;
+
+    chess_mutex_lock(&pool->mutex);
+    if (require_idle && pool->idle_count <= pool->queued_count) {
+        chess_mutex_unlock(&pool->mutex);
+        free(future);
+        return NULL;
+    }
+    future->prev = pool->tail;
+    if (pool->tail != NULL) {
+        pool->tail->next = future;
+    } else {
+        pool->head = future;
+    }
+    pool->tail = future;
+    pool->queued_count++;
+    chess_cond_signal(&pool->task_ready);
+    chess_mutex_unlock(&pool->mutex);
+    return future;
+}
+
+ChessFuture* chess_pool_submit(ChessThreadPool* pool, ChessThreadStart start, void* arg) {
+    return pool_submit(pool, start, arg, false);
+}
+
+ChessFuture* chess_pool_submit_if_idle(ChessThreadPool* pool, ChessThreadStart start, void* arg) {
+    return pool_submit(pool, start, arg, true);
+}
+
+bool chess_future_is_ready(ChessFuture* future) {
+    bool ready;
+
+    if (future == NULL) {
+        return false;
+    }
+    chess_mutex_lock(&future->pool->mutex);
+    ready = future->state == FUTURE_DONE;
+    chess_mutex_unlock(&future->pool->mutex);
+    return ready;
+}
+
+void* chess_future_wait(ChessFuture* future) {
+    ChessThreadPool* pool;
+    void* result;
+
+    if (future == NULL) {
+        return NULL;
+    }
+
+    pool = future->pool;
+    chess_mutex_lock(&pool->mutex);
+    if (future->state == FUTURE_QUEUED) {
+        pool_unlink(pool, future);
+        pool_run_locked(pool, future);
+    }
+    while (future->state != FUTURE_DONE) {
+        chess_cond_wait(&pool->task_done, &pool->mutex);
+    }
+    chess_mutex_unlock(&pool->mutex);
+
+    result = future->result;
+    free(future);
+    return result;
+}
+
+ChessThreadPool* chess_pool_shared(void) {
+    ChessThreadPool* pool = atomic_load(&g_shared_pool);
+    ChessThreadPool* expected = NULL;
+    int thread_count;
+
+    if (pool != NULL) {
+        return pool;
+    }
+
+    thread_count = chess_cpu_count();
+    if (thread_count < CHESS_POOL_MIN_THREADS) {
+        thread_count = CHESS_POOL_MIN_THREADS;
+    }
+    pool = chess_pool_create(thread_count, false);
+    if (pool == NULL) {
+        return NULL;
+    }
+    /* Two first callers may race; the loser discards its idle pool. */
+    if (!atomic_compare_exchange_strong(&g_shared_pool, &expected, pool)) {
+        chess_pool_destroy(pool);
+        return expected;
+    }
+    return pool;
+}
+
+void chess_pool_shutdown_shared(void) {
+    chess_pool_destroy(atomic_exchange(&g_shared_pool, NULL));
+}
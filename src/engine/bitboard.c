@@ -1,4 +1,5 @@
 #include "engine.h"
+#include "engine_internal.h"
 
 #include <ctype.h>
 #include <string.h>
@@ -7,24 +8,97 @@
 #include <intrin.h>
 #endif
 
-/* File masks used for pawn attack shifts to avoid board wrap-around. */
-#define NOT_FILE_A 0xFEFEFEFEFEFEFEFEULL
-#define NOT_FILE_H 0x7F7F7F7F7F7F7F7FULL
+/* PEXT slider indexing is only compiled for x86-64; other hosts always use magics. */
+#if defined(__x86_64__) || defined(_M_X64)
+#define CHESS_HAS_PEXT_PATH 1
+#if defined(__GNUC__) || defined(__clang__)
+#include <cpuid.h>
+#endif
+#else
+#define CHESS_HAS_PEXT_PATH 0
+#endif
+
+/* Shared slider attack table sizes (sum of 2^bits over all squares). */
+#define ROOK_ATTACK_TABLE_SIZE 102400
+#define BISHOP_ATTACK_TABLE_SIZE 5248
+
+/* Per-square magic lookup entry (mask, multiplier, shift and table slice). */
+typedef struct SliderMagic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard* attacks;
+    unsigned shift;
+} SliderMagic;
 
 /* Precomputed attack tables. */
 static Bitboard g_knight_attacks[BOARD_SQUARES];
 static Bitboard g_king_attacks[BOARD_SQUARES];
 static Bitboard g_pawn_attacks[2][BOARD_SQUARES];
 
-/* Zobrist hash random tables. */
-static uint64_t g_zobrist_piece[2][6][BOARD_SQUARES];
-static uint64_t g_zobrist_castling[16];
-static uint64_t g_zobrist_ep_file[8];
-static uint64_t g_zobrist_side;
+/* Magic-indexed slider attack tables. */
+static SliderMagic g_bishop_magics[BOARD_SQUARES];
+static SliderMagic g_rook_magics[BOARD_SQUARES];
+static Bitboard g_bishop_attack_table[BISHOP_ATTACK_TABLE_SIZE];
+static Bitboard g_rook_attack_table[ROOK_ATTACK_TABLE_SIZE];
+
+/* Square-pair geometry: squares strictly between, and the full shared line. */
+static Bitboard g_between[BOARD_SQUARES][BOARD_SQUARES];
+static Bitboard g_line[BOARD_SQUARES][BOARD_SQUARES];
+
+/* Zobrist hash random tables (shared with make-move via engine_internal.h). */
+uint64_t g_zobrist_piece[2][6][BOARD_SQUARES];
+uint64_t g_zobrist_castling[16];
+uint64_t g_zobrist_ep_file[8];
+uint64_t g_zobrist_side;
+
+/* Active slider indexing scheme; tables are laid out for this backend. */
+static SliderBackend g_slider_backend = SLIDER_BACKEND_MAGIC;
 
 static bool g_engine_initialized = false;
 static uint64_t g_rng_state = 0xA5A5A5A5D3C1F27BULL;
 
+/*
+ * Magic multipliers (a1..h8), found offline with a sparse-random search over all
+ * relevant-occupancy subsets. Each maps every subset to a collision-free slot.
+ */
+static const Bitboard g_bishop_magic_numbers[BOARD_SQUARES] = {
+    0x10102002004A1420ULL, 0x8020040400584008ULL, 0x10510800811201C8ULL, 0x5204042080000088ULL,
+    0x2204106880000002ULL, 0x1401042004000000ULL, 0x0400880410042004ULL, 0x0028208200A02020ULL,
+    0x1500241990010E00ULL, 0x8001200182020A40ULL, 0x40004101030B0000ULL, 0x8002041042000100ULL,
+    0x4010011041020038ULL, 0x0000010421044000ULL, 0x1500210808020A00ULL, 0x8000088400880520ULL,
+    0x0405004010040100ULL, 0x1005823210040108ULL, 0x2708008102040011ULL, 0x4048200404009100ULL,
+    0x0018104101400024ULL, 0x0003000601190101ULL, 0x8004803108491000ULL, 0x8014241200820800ULL,
+    0x0006E080100C3040ULL, 0x0501044A11041800ULL, 0x9020300008004045ULL, 0x0894080000220040ULL,
+    0x1001010083104000ULL, 0x5004030040900080ULL, 0x000400422C012400ULL, 0x0002128698404812ULL,
+    0x1010108404900440ULL, 0x0928021182084100ULL, 0x2006080409020024ULL, 0x1010202020180080ULL,
+    0xA010008200202200ULL, 0x2098015100019004ULL, 0x0002041440810811ULL, 0x802A02020000B098ULL,
+    0x0009015090004060ULL, 0x4000821082081001ULL, 0x0100210040420800ULL, 0x0800004010488A00ULL,
+    0x2000081104004040ULL, 0x4C8E029015000082ULL, 0x0420340322224842ULL, 0x1298260043400210ULL,
+    0x0000822802400008ULL, 0x00008A0101600000ULL, 0x3040003412080021ULL, 0x3040290220884800ULL,
+    0x4A1500401041004AULL, 0x8010200282020781ULL, 0x0020203142209091ULL, 0x0070300600902110ULL,
+    0x0040808800B62048ULL, 0x0000810400C44420ULL, 0x00080400440C0441ULL, 0x8340080020840411ULL,
+    0x0000000104208200ULL, 0x0000800810D00080ULL, 0x0400530411080200ULL, 0x4040702400932244ULL
+};
+
+static const Bitboard g_rook_magic_numbers[BOARD_SQUARES] = {
+    0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+    0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+    0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+    0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+    0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+    0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+    0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+    0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+    0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+    0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+    0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+    0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+    0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+    0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+    0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+    0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL
+};
+
 /* Returns a single-bit bitboard for one square index. */
 static Bitboard bb_square(int square) {
     return 1ULL << square;
@@ -257,6 +331,220 @@ static void init_pawn_attacks(void) {
     }
 }
 
+/* Reference bishop ray walk (used only to build magic tables). */
+static Bitboard bishop_attacks_slow(int square, Bitboard occupancy) {
+    static const int directions[4] = {9, 7, -7, -9};
+    Bitboard attacks = 0ULL;
+
+    for (int i = 0; i < 4; ++i) {
+        int dir = directions[i];
+        int sq = square;
+
+        while (true) {
+            int next = sq + dir;
+            if (!is_square_on_board(next)) {
+                break;
+            }
+
+            {
+                int sq_file = sq & 7;
+                int next_file = next & 7;
+
+                if ((dir == 9 || dir == -7) && next_file != sq_file + 1) {
+                    break;
+                }
+                if ((dir == 7 || dir == -9) && next_file != sq_file - 1) {
+                    break;
+                }
+            }
+
+            attacks |= bb_square(next);
+            if ((occupancy & bb_square(next)) != 0ULL) {
+                break;
+            }
+
+            sq = next;
+        }
+    }
+
+    return attacks;
+}
+
+/* Reference rook ray walk (used only to build magic tables). */
+static Bitboard rook_attacks_slow(int square, Bitboard occupancy) {
+    static const int directions[4] = {8, -8, 1, -1};
+    Bitboard attacks = 0ULL;
+
+    for (int i = 0; i < 4; ++i) {
+        int dir = directions[i];
+        int sq = square;
+
+        while (true) {
+            int next = sq + dir;
+            if (!is_square_on_board(next)) {
+                break;
+            }
+
+            if ((dir == 1 || dir == -1) && ((sq >> 3) != (next >> 3))) {
+                break;
+            }
+
+            attacks |= bb_square(next);
+            if ((occupancy & bb_square(next)) != 0ULL) {
+                break;
+            }
+
+            sq = next;
+        }
+    }
+
+    return attacks;
+}
+
+#if CHESS_HAS_PEXT_PATH
+/*
+ * Parallel bit extract. Inline asm keeps the call inlinable from code built
+ * without -mbmi2; it is only reached after the CPUID check enabled PEXT.
+ */
+static Bitboard pext_u64(Bitboard value, Bitboard mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    Bitboard result;
+    __asm__("pextq %2, %1, %0" : "=r"(result) : "r"(value), "r"(mask));
+    return result;
+#else
+    return (Bitboard)_pext_u64((unsigned __int64)value, (unsigned __int64)mask);
+#endif
+}
+#endif
+
+/* True when the CPU implements BMI2 with a fast (non-microcoded) PEXT. */
+static bool cpu_has_fast_pext(void) {
+#if CHESS_HAS_PEXT_PATH
+    unsigned regs[4] = {0U, 0U, 0U, 0U};
+    unsigned family;
+    bool amd;
+
+#if defined(__GNUC__) || defined(__clang__)
+    if (!__get_cpuid_count(7U, 0U, &regs[0], &regs[1], &regs[2], &regs[3])) {
+        return false;
+    }
+#else
+    __cpuidex((int*)regs, 7, 0);
+#endif
+    if ((regs[1] & (1U << 8)) == 0U) {
+        return false;
+    }
+
+    /* AMD before Zen 3 (family 19h) runs PEXT in microcode; magics win there. */
+#if defined(__GNUC__) || defined(__clang__)
+    __get_cpuid(0U, &regs[0], &regs[1], &regs[2], &regs[3]);
+#else
+    __cpuid((int*)regs, 0);
+#endif
+    amd = regs[1] == 0x68747541U && regs[3] == 0x69746E65U && regs[2] == 0x444D4163U;
+    if (!amd) {
+        return true;
+    }
+
+#if defined(__GNUC__) || defined(__clang__)
+    __get_cpuid(1U, &regs[0], &regs[1], &regs[2], &regs[3]);
+#else
+    __cpuid((int*)regs, 1);
+#endif
+    family = ((regs[0] >> 8) & 0x0FU) + ((regs[0] >> 20) & 0xFFU);
+    return family >= 0x19U;
+#else
+    return false;
+#endif
+}
+
+/* Maps one occupancy to its slot inside a square's attack-table slice (multiply-shift). */
+static unsigned magic_index_mul(const SliderMagic* m, Bitboard occupancy) {
+    return (unsigned)(((occupancy & m->mask) * m->magic) >> m->shift);
+}
+
+#if CHESS_HAS_PEXT_PATH
+/* Same slot for the PEXT layout: the relevant occupancy bits packed densely. */
+static unsigned magic_index_pext(const SliderMagic* m, Bitboard occupancy) {
+    return (unsigned)pext_u64(occupancy, m->mask);
+}
+#endif
+
+/* Index function of the active backend, set with g_slider_backend so lookups never re-check it. */
+static unsigned (*g_slider_index)(const SliderMagic* m, Bitboard occupancy) = magic_index_mul;
+
+/*
+ * Fills one slider's shared attack table using the active backend's indexing.
+ * Relevant-occupancy masks exclude board edges because an edge blocker never
+ * changes the attack set; every subset is enumerated with the carry-rippler trick.
+ */
+static void init_slider_magics(SliderMagic magics[BOARD_SQUARES],
+                               const Bitboard magic_numbers[BOARD_SQUARES],
+                               Bitboard* table,
+                               Bitboard (*slow_attacks)(int, Bitboard)) {
+    Bitboard* slice = table;
+
+    for (int sq = 0; sq < BOARD_SQUARES; ++sq) {
+        Bitboard rank_edges = 0xFF000000000000FFULL & ~(0xFFULL << ((sq >> 3) * 8));
+        Bitboard file_edges = 0x8181818181818181ULL & ~(0x0101010101010101ULL << (sq & 7));
+        SliderMagic* m = &magics[sq];
+        Bitboard occ = 0ULL;
+
+        m->mask = slow_attacks(sq, 0ULL) & ~(rank_edges | file_edges);
+        m->magic = magic_numbers[sq];
+        m->shift = (unsigned)(64 - bit_count(m->mask));
+        m->attacks = slice;
+
+        do {
+            m->attacks[g_slider_index(m, occ)] = slow_attacks(sq, occ);
+            occ = (occ - m->mask) & m->mask;
+        } while (occ != 0ULL);
+
+        slice += 1ULL << bit_count(m->mask);
+    }
+}
+
+/* Rebuilds both slider tables for the currently selected backend. */
+static void init_slider_tables(void) {
+    init_slider_magics(g_bishop_magics, g_bishop_magic_numbers, g_bishop_attack_table, bishop_attacks_slow);
+    init_slider_magics(g_rook_magics, g_rook_magic_numbers, g_rook_attack_table, rook_attacks_slow);
+}
+
+/* Selects the indexing backend and lays out both attack tables for it. */
+static void select_slider_backend(SliderBackend backend) {
+    g_slider_backend = backend;
+    g_slider_index = magic_index_mul;
+#if CHESS_HAS_PEXT_PATH
+    if (backend == SLIDER_BACKEND_PEXT) {
+        g_slider_index = magic_index_pext;
+    }
+#endif
+    init_slider_tables();
+}
+
+/* Builds between/line masks for every aligned square pair (pin and check masks). */
+static void init_line_tables(void) {
+    for (int a = 0; a < BOARD_SQUARES; ++a) {
+        for (int b = 0; b < BOARD_SQUARES; ++b) {
+            Bitboard ends = bb_square(a) | bb_square(b);
+
+            g_between[a][b] = 0ULL;
+            g_line[a][b] = 0ULL;
+            if (a == b) {
+                continue;
+            }
+
+            if ((rook_attacks_slow(a, 0ULL) & bb_square(b)) != 0ULL) {
+                g_between[a][b] = rook_attacks_slow(a, bb_square(b)) & rook_attacks_slow(b, bb_square(a));
+                g_line[a][b] = (rook_attacks_slow(a, 0ULL) & rook_attacks_slow(b, 0ULL)) | ends;
+            } else if ((bishop_attacks_slow(a, 0ULL) & bb_square(b)) != 0ULL) {
+                g_between[a][b] = bishop_attacks_slow(a, bb_square(b)) & bishop_attacks_slow(b, bb_square(a));
+                g_line[a][b] = (bishop_attacks_slow(a, 0ULL) & bishop_attacks_slow(b, 0ULL)) | ends;
+            }
+        }
+    }
+}
+
 /* Seeds all zobrist lookup tables. */
 static void init_zobrist(void) {
     for (int side = 0; side < 2; ++side) {
@@ -289,27 +577,70 @@ void engine_init(void) {
     init_knight_attacks();
     init_king_attacks();
     init_pawn_attacks();
+    select_slider_backend(cpu_has_fast_pext() ? SLIDER_BACKEND_PEXT : SLIDER_BACKEND_MAGIC);
+    init_line_tables();
     init_zobrist();
+    engine_init_psq_tables();
+    engine_init_opening_book();
 
     g_engine_initialized = true;
 }
 
+bool engine_set_slider_backend(SliderBackend backend) {
+    if (!g_engine_initialized) {
+        return false;
+    }
+    if (backend == SLIDER_BACKEND_PEXT && !cpu_has_fast_pext()) {
+        return false;
+    }
+    if (backend != SLIDER_BACKEND_MAGIC && backend != SLIDER_BACKEND_PEXT) {
+        return false;
+    }
+
+    select_slider_backend(backend);
+    return true;
+}
+
+SliderBackend engine_get_slider_backend(void) {
+    return g_slider_backend;
+}
+
 /* Clears position object to a deterministic empty state. */
 void position_set_empty(Position* pos) {
     memset(pos, 0, sizeof(*pos));
+    memset(pos->board, MAILBOX_EMPTY, sizeof(pos->board));
     pos->en_passant_square = -1;
     pos->side_to_move = SIDE_WHITE;
     pos->fullmove_number = 1;
 }
 
-/* Recomputes side and total occupancy bitboards from piece bitboards. */
+/* Recomputes occupancy, the square mailbox, pawn key and material/PST totals from piece bitboards. */
 void position_refresh_occupancy(Position* pos) {
     pos->occupied[SIDE_WHITE] = 0ULL;
     pos->occupied[SIDE_BLACK] = 0ULL;
+    pos->pawn_key = 0ULL;
+    pos->psq_mg = 0;
+    pos->psq_eg = 0;
+    pos->phase = 0;
+    memset(pos->board, MAILBOX_EMPTY, sizeof(pos->board));
+
+    for (int side = 0; side < 2; ++side) {
+        for (int piece = 0; piece < 6; ++piece) {
+            Bitboard bb = pos->pieces[side][piece];
+
+            pos->occupied[side] |= bb;
+            while (bb != 0ULL) {
+                int sq = pop_lsb(&bb);
 
-    for (int piece = 0; piece < 6; ++piece) {
-        pos->occupied[SIDE_WHITE] |= pos->pieces[SIDE_WHITE][piece];
-        pos->occupied[SIDE_BLACK] |= pos->pieces[SIDE_BLACK][piece];
+                pos->board[sq] = (uint8_t)((side << 3) | piece);
+                pos->psq_mg += g_psq_mg[side][piece][sq];
+                pos->psq_eg += g_psq_eg[side][piece][sq];
+                pos->phase = (int16_t)(pos->phase + g_phase_weights[piece]);
+                if (piece == PIECE_PAWN) {
+                    pos->pawn_key ^= g_zobrist_piece[side][PIECE_PAWN][sq];
+                }
+            }
+        }
     }
 
     pos->all_occupied = pos->occupied[SIDE_WHITE] | pos->occupied[SIDE_BLACK];
@@ -560,74 +891,28 @@ Bitboard engine_get_pawn_attacks(Side side, int square) {
     return g_pawn_attacks[side][square];
 }
 
-/* Runtime bishop rays with occupancy blocking. */
+/* Table-driven bishop attacks (magic multiply-shift or PEXT index). */
 Bitboard engine_get_bishop_attacks(int square, Bitboard occupancy) {
-    static const int directions[4] = {9, 7, -7, -9};
-    Bitboard attacks = 0ULL;
-
-    for (int i = 0; i < 4; ++i) {
-        int dir = directions[i];
-        int sq = square;
-
-        while (true) {
-            int next = sq + dir;
-            if (!is_square_on_board(next)) {
-                break;
-            }
-
-            {
-                int sq_file = sq & 7;
-                int next_file = next & 7;
-
-                if ((dir == 9 || dir == -7) && next_file != sq_file + 1) {
-                    break;
-                }
-                if ((dir == 7 || dir == -9) && next_file != sq_file - 1) {
-                    break;
-                }
-            }
-
-            attacks |= bb_square(next);
-            if ((occupancy & bb_square(next)) != 0ULL) {
-                break;
-            }
+    const SliderMagic* m;
 
-            sq = next;
-        }
+    if (!is_square_on_board(square)) {
+        return 0ULL;
     }
 
-    return attacks;
+    m = &g_bishop_magics[square];
+    return m->attacks[g_slider_index(m, occupancy)];
 }
 
-/* Runtime rook rays with occupancy blocking. */
+/* Table-driven rook attacks (magic multiply-shift or PEXT index). */
 Bitboard engine_get_rook_attacks(int square, Bitboard occupancy) {
-    static const int directions[4] = {8, -8, 1, -1};
-    Bitboard attacks = 0ULL;
-
-    for (int i = 0; i < 4; ++i) {
-        int dir = directions[i];
-        int sq = square;
-
-        while (true) {
-            int next = sq + dir;
-            if (!is_square_on_board(next)) {
-                break;
-            }
-
-            if ((dir == 1 || dir == -1) && ((sq >> 3) != (next >> 3))) {
-                break;
-            }
-
-            attacks |= bb_square(next);
-            if ((occupancy & bb_square(next)) != 0ULL) {
-                break;
-            }
+    const SliderMagic* m;
 
-            sq = next;
-        }
+    if (!is_square_on_board(square)) {
+        return 0ULL;
     }
 
-    return attacks;
+    m = &g_rook_magics[square];
+    return m->attacks[g_slider_index(m, occupancy)];
 }
 
 /* Returns king square index for a side, or -1 if not present. */
@@ -640,98 +925,87 @@ int engine_find_king_square(const Position* pos, Side side) {
     return bit_scan_forward(king);
 }
 
-/* True when a square is attacked by at least one piece of the given side. */
-bool engine_is_square_attacked(const Position* pos, int square, Side by_side) {
-    Bitboard target;
-
-    if (!is_square_on_board(square)) {
-        return false;
+/* Squares strictly between two aligned squares (empty when not on one line). */
+Bitboard engine_get_between(int from, int to) {
+    if (!is_square_on_board(from) || !is_square_on_board(to)) {
+        return 0ULL;
     }
-    target = bb_square(square);
+    return g_between[from][to];
+}
 
-    {
-        Bitboard pawns = pos->pieces[by_side][PIECE_PAWN];
-        Bitboard pawn_attacks;
+/* Full board line through two aligned squares (empty when not on one line). */
+Bitboard engine_get_line(int a, int b) {
+    if (!is_square_on_board(a) || !is_square_on_board(b)) {
+        return 0ULL;
+    }
+    return g_line[a][b];
+}
 
-        if (by_side == SIDE_WHITE) {
-            pawn_attacks = ((pawns << 7) & NOT_FILE_H) | ((pawns << 9) & NOT_FILE_A);
-        } else {
-            pawn_attacks = ((pawns >> 7) & NOT_FILE_A) | ((pawns >> 9) & NOT_FILE_H);
-        }
+/* All pieces of both sides attacking a square under a caller-supplied occupancy. */
+Bitboard engine_attackers_to(const Position* pos, int square, Bitboard occupancy) {
+    Bitboard diagonal;
+    Bitboard straight;
 
-        if ((pawn_attacks & target) != 0ULL) {
-            return true;
-        }
+    if (!is_square_on_board(square)) {
+        return 0ULL;
     }
 
-    {
-        Bitboard knights = pos->pieces[by_side][PIECE_KNIGHT];
-        while (knights != 0ULL) {
-            int sq = pop_lsb(&knights);
-            if ((g_knight_attacks[sq] & target) != 0ULL) {
-                return true;
-            }
-        }
-    }
+    diagonal = pos->pieces[SIDE_WHITE][PIECE_BISHOP] | pos->pieces[SIDE_BLACK][PIECE_BISHOP] |
+               pos->pieces[SIDE_WHITE][PIECE_QUEEN] | pos->pieces[SIDE_BLACK][PIECE_QUEEN];
+    straight = pos->pieces[SIDE_WHITE][PIECE_ROOK] | pos->pieces[SIDE_BLACK][PIECE_ROOK] |
+               pos->pieces[SIDE_WHITE][PIECE_QUEEN] | pos->pieces[SIDE_BLACK][PIECE_QUEEN];
+
+    return (g_pawn_attacks[SIDE_BLACK][square] & pos->pieces[SIDE_WHITE][PIECE_PAWN]) |
+           (g_pawn_attacks[SIDE_WHITE][square] & pos->pieces[SIDE_BLACK][PIECE_PAWN]) |
+           (g_knight_attacks[square] & (pos->pieces[SIDE_WHITE][PIECE_KNIGHT] | pos->pieces[SIDE_BLACK][PIECE_KNIGHT])) |
+           (g_king_attacks[square] & (pos->pieces[SIDE_WHITE][PIECE_KING] | pos->pieces[SIDE_BLACK][PIECE_KING])) |
+           (engine_get_bishop_attacks(square, occupancy) & diagonal) |
+           (engine_get_rook_attacks(square, occupancy) & straight);
+}
 
-    {
-        Bitboard bishops = pos->pieces[by_side][PIECE_BISHOP] | pos->pieces[by_side][PIECE_QUEEN];
-        while (bishops != 0ULL) {
-            int sq = pop_lsb(&bishops);
-            if ((engine_get_bishop_attacks(sq, pos->all_occupied) & target) != 0ULL) {
-                return true;
-            }
-        }
-    }
+/* True when a square is attacked by at least one piece of the given side. */
+bool engine_is_square_attacked(const Position* pos, int square, Side by_side) {
+    Side defender = (by_side == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
 
-    {
-        Bitboard rooks = pos->pieces[by_side][PIECE_ROOK] | pos->pieces[by_side][PIECE_QUEEN];
-        while (rooks != 0ULL) {
-            int sq = pop_lsb(&rooks);
-            if ((engine_get_rook_attacks(sq, pos->all_occupied) & target) != 0ULL) {
-                return true;
-            }
-        }
+    if (!is_square_on_board(square)) {
+        return false;
     }
 
-    {
-        Bitboard king = pos->pieces[by_side][PIECE_KING];
-        if (king != 0ULL) {
-            int king_sq = bit_scan_forward(king);
+    /* Reverse lookups: attack sets from the target square intersected with attackers. */
+    if ((g_pawn_attacks[defender][square] & pos->pieces[by_side][PIECE_PAWN]) != 0ULL ||
+        (g_knight_attacks[square] & pos->pieces[by_side][PIECE_KNIGHT]) != 0ULL ||
+        (g_king_attacks[square] & pos->pieces[by_side][PIECE_KING]) != 0ULL) {
+        return true;
+    }
 
-            if ((g_king_attacks[king_sq] & target) != 0ULL) {
-                return true;
-            }
-        }
+    if ((engine_get_bishop_attacks(square, pos->all_occupied) &
+         (pos->pieces[by_side][PIECE_BISHOP] | pos->pieces[by_side][PIECE_QUEEN])) != 0ULL) {
+        return true;
     }
 
-    return false;
+    return (engine_get_rook_attacks(square, pos->all_occupied) &
+            (pos->pieces[by_side][PIECE_ROOK] | pos->pieces[by_side][PIECE_QUEEN])) != 0ULL;
 }
 
-/* Piece lookup helper for GUI/debug/network validation paths. */
+/* O(1) piece lookup through the square mailbox. */
 bool position_piece_at(const Position* pos, int square, Side* out_side, PieceType* out_piece) {
+    uint8_t code;
+
     if (!is_square_on_board(square)) {
         return false;
     }
 
-    {
-        Bitboard mask = bb_square(square);
-        for (int side = 0; side < 2; ++side) {
-            for (int piece = 0; piece < 6; ++piece) {
-                if ((pos->pieces[side][piece] & mask) != 0ULL) {
-                    if (out_side != NULL) {
-                        *out_side = (Side)side;
-                    }
-                    if (out_piece != NULL) {
-                        *out_piece = (PieceType)piece;
-                    }
-                    return true;
-                }
-            }
-        }
+    code = pos->board[square];
+    if (code == MAILBOX_EMPTY) {
+        return false;
     }
-
-    return false;
+    if (out_side != NULL) {
+        *out_side = (Side)(code >> 3);
+    }
+    if (out_piece != NULL) {
+        *out_piece = (PieceType)(code & 7U);
+    }
+    return true;
 }
 
 /* Converts piece identity to a simple character representation. */
@@ -802,7 +1076,6 @@ bool move_from_uci(const char* text, Move* out_move) {
     move.to = (uint8_t)((to_rank << 3) | to_file);
     move.flags = MOVE_FLAG_NONE;
     move.promotion = PIECE_NONE;
-    move.score = 0;
 
     if (len == 5) {
         char promo = text[4];
@@ -0,0 +1,117 @@
+#ifndef ENGINE_INTERNAL_H
+#define ENGINE_INTERNAL_H
+
+/*
+ * Engine-private tables and move encoding shared by bitboard.c, movegen.c and
+ * search.c. Not part of the public engine API; tables are filled once by
+ * engine_init() and read-only afterwards.
+ */
+
+#include "engine.h"
+#include "types.h"
+
+/* Zobrist hash random tables (see position_compute_zobrist for key layout). */
+extern uint64_t g_zobrist_piece[2][6][BOARD_SQUARES];
+extern uint64_t g_zobrist_castling[16];
+extern uint64_t g_zobrist_ep_file[8];
+extern uint64_t g_zobrist_side;
+
+/*
+ * Material + piece-square values per (side, piece, square), signed White-positive,
+ * and per-piece phase weights. Position.psq_mg/psq_eg/phase are sums of these.
+ */
+extern int32_t g_psq_mg[2][6][BOARD_SQUARES];
+extern int32_t g_psq_eg[2][6][BOARD_SQUARES];
+extern const int g_phase_weights[6];
+
+/* Builds g_psq_mg/g_psq_eg from the evaluation tables (called by engine_init). */
+void engine_init_psq_tables(void);
+/* Builds the shared opening book from its seed lines (called by engine_init, after the PSQ tables). */
+void engine_init_opening_book(void);
+/* Bench override of engine_init's CPUID backend choice; rebuilds the shared slider tables, so call it before any search. */
+bool engine_set_slider_backend(SliderBackend backend);
+
+/*
+ * Packed 16-bit move used inside the engine and in the TT:
+ * bits 0-5 from, bits 6-11 to, bits 12-15 MOVE_KIND_*. Kind bit 2 marks a capture
+ * and bit 3 a promotion whose low two bits select knight..queen. The public Move
+ * struct is only built at the API boundary (engine_unpack_move).
+ */
+typedef uint16_t PackedMove;
+
+#define PACKED_MOVE_NONE ((PackedMove)0U)
+
+#define MOVE_KIND_QUIET 0U
+#define MOVE_KIND_DOUBLE_PAWN 1U
+#define MOVE_KIND_KING_CASTLE 2U
+#define MOVE_KIND_QUEEN_CASTLE 3U
+#define MOVE_KIND_CAPTURE 4U
+#define MOVE_KIND_EN_PASSANT 5U
+#define MOVE_KIND_PROMOTION 8U
+
+#define PACKED_MOVE(from, to, kind) ((PackedMove)((unsigned)(from) | ((unsigned)(to) << 6) | ((unsigned)(kind) << 12)))
+#define PACKED_FROM(m) ((int)((m) & 63U))
+#define PACKED_TO(m) ((int)(((m) >> 6) & 63U))
+#define PACKED_KIND(m) ((unsigned)((m) >> 12))
+#define PACKED_IS_CAPTURE(m) ((PACKED_KIND(m) & MOVE_KIND_CAPTURE) != 0U)
+#define PACKED_IS_PROMOTION(m) ((PACKED_KIND(m) & MOVE_KIND_PROMOTION) != 0U)
+#define PACKED_IS_TACTICAL(m) ((PACKED_KIND(m) & (MOVE_KIND_CAPTURE | MOVE_KIND_PROMOTION)) != 0U)
+#define PACKED_IS_CASTLE(m) (PACKED_KIND(m) == MOVE_KIND_KING_CASTLE || PACKED_KIND(m) == MOVE_KIND_QUEEN_CASTLE)
+#define PACKED_PROMOTION_PIECE(m) ((PieceType)(PIECE_KNIGHT + (PACKED_KIND(m) & 3U)))
+
+/* Engine-internal move list; half the size of a MoveList of the public struct. */
+typedef struct PackedMoveList {
+    PackedMove moves[MAX_MOVES];
+    int count;
+} PackedMoveList;
+
+/* Conversions at the public API boundary. */
+PackedMove engine_pack_move(Move move);
+Move engine_unpack_move(PackedMove move);
+
+/* Packed-move generation, validation and in-place make/unmake (see engine.h for semantics). */
+void engine_generate_legal_packed(const Position* pos, PackedMoveList* list);
+void engine_generate_captures_packed(const Position* pos, PackedMoveList* list);
+void engine_generate_evasions_packed(const Position* pos, PackedMoveList* list);
+bool engine_packed_is_legal(const Position* pos, PackedMove move);
+bool engine_make_packed(Position* pos, PackedMove move, MoveUndo* undo);
+void engine_unmake_packed(Position* pos, PackedMove move, const MoveUndo* undo);
+int engine_see_packed(const Position* pos, PackedMove move);
+
+/*
+ * Per-search time budget (timeman.c) on a monotonic millisecond clock. The soft limit is
+ * the target spend, scaled by best-move stability; the hard limit is never exceeded.
+ * Both are 0 when the search has no time limit. An optional node budget is treated the
+ * same way as the hard limit, so iterations that cannot finish inside it are not started.
+ */
+typedef struct TimeManager {
+    uint64_t start_ms;
+    uint64_t iteration_start_ms;
+    int soft_ms;
+    int hard_ms;
+    int last_iteration_ms;
+    int prev_iteration_ms;
+    uint64_t max_nodes;
+    uint64_t iteration_start_nodes;
+    uint64_t last_iteration_nodes;
+    uint64_t prev_iteration_nodes;
+    int instability; /* Decaying count of best-move changes and score drops, x100. */
+    int stable_iterations;
+    PackedMove last_best;
+    int last_score;
+    bool has_iteration;
+} TimeManager;
+
+uint64_t engine_clock_ms(void);
+void time_manager_init(TimeManager* tm, const SearchLimits* limits);
+/* True once the hard limit has passed (polled from the node loop). */
+bool time_manager_expired(const TimeManager* tm);
+/* Records a completed iteration's duration, node count (running total), best move and score. */
+void time_manager_iteration_done(TimeManager* tm, uint64_t nodes, PackedMove best, int score);
+/*
+ * Whether another iteration should start: under the scaled soft limit and predicted to end
+ * before the hard one and inside the node budget (`nodes` is the running total).
+ */
+bool time_manager_next_iteration_fits(const TimeManager* tm, uint64_t nodes);
+
+#endif
@@ -1,5 +1,7 @@
 #include "engine.h"
+#include "engine_internal.h"
 
+#include <assert.h>
 #include <string.h>
 #ifdef _MSC_VER
 #include <intrin.h>
@@ -55,121 +57,226 @@ static bool move_same_for_validation(Move a, Move b) {
 }
 
 /* Appends move if list capacity allows it. */
-static void add_move(MoveList* list, uint8_t from, uint8_t to, uint8_t flags, uint8_t promotion) {
+static void add_move(PackedMoveList* list, int from, int to, unsigned kind) {
     if (list->count >= MAX_MOVES) {
         return;
     }
 
-    list->moves[list->count].from = from;
-    list->moves[list->count].to = to;
-    list->moves[list->count].flags = flags;
-    list->moves[list->count].promotion = promotion;
-    list->moves[list->count].score = 0;
-    list->count++;
+    list->moves[list->count++] = PACKED_MOVE(from, to, kind);
+}
+
+/* Promotion kind for one target piece, keeping the capture bit of base_kind. */
+static unsigned promotion_kind(unsigned base_kind, PieceType piece) {
+    return (base_kind & MOVE_KIND_CAPTURE) | MOVE_KIND_PROMOTION | (unsigned)(piece - PIECE_KNIGHT);
 }
 
 /* Generates four promotion variants for one pawn destination. */
-static void add_promotion_moves(MoveList* list, uint8_t from, uint8_t to, uint8_t base_flags) {
-    add_move(list, from, to, (uint8_t)(base_flags | MOVE_FLAG_PROMOTION), PIECE_QUEEN);
-    add_move(list, from, to, (uint8_t)(base_flags | MOVE_FLAG_PROMOTION), PIECE_ROOK);
-    add_move(list, from, to, (uint8_t)(base_flags | MOVE_FLAG_PROMOTION), PIECE_BISHOP);
-    add_move(list, from, to, (uint8_t)(base_flags | MOVE_FLAG_PROMOTION), PIECE_KNIGHT);
+static void add_promotion_moves(PackedMoveList* list, int from, int to, unsigned base_kind) {
+    add_move(list, from, to, promotion_kind(base_kind, PIECE_QUEEN));
+    add_move(list, from, to, promotion_kind(base_kind, PIECE_ROOK));
+    add_move(list, from, to, promotion_kind(base_kind, PIECE_BISHOP));
+    add_move(list, from, to, promotion_kind(base_kind, PIECE_KNIGHT));
 }
 
-/* Generates all pseudo-legal pawn moves for one side. */
-static void generate_pawn_moves(const Position* pos, Side us, MoveList* list) {
-    Side them = (us == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
+/*
+ * Legality masks computed once per position. Every non-king move must land in
+ * check_mask (all squares when not in check, the checker and its blocking ray for
+ * a single check, nothing for a double check); pinned pieces stay on their pin line.
+ */
+typedef struct LegalityInfo {
+    Side us;
+    Side them;
+    int king_square;
+    Bitboard checkers;
+    Bitboard check_mask;
+    Bitboard pinned;
+} LegalityInfo;
+
+/* Computes checkers, check-evasion mask and absolutely pinned pieces for side to move. */
+static void compute_legality_info(const Position* pos, LegalityInfo* info) {
+    Bitboard snipers;
+
+    info->us = pos->side_to_move;
+    info->them = (info->us == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
+    info->king_square = engine_find_king_square(pos, info->us);
+    info->checkers = 0ULL;
+    info->check_mask = ~0ULL;
+    info->pinned = 0ULL;
+
+    if (info->king_square < 0) {
+        return;
+    }
+
+    info->checkers = engine_attackers_to(pos, info->king_square, pos->all_occupied) & pos->occupied[info->them];
+    if (info->checkers != 0ULL) {
+        if ((info->checkers & (info->checkers - 1ULL)) != 0ULL) {
+            info->check_mask = 0ULL;
+        } else {
+            info->check_mask = info->checkers |
+                               engine_get_between(info->king_square, bit_scan_forward(info->checkers));
+        }
+    }
+
+    /* Enemy sliders that would see the king if only enemy pieces were on the board. */
+    snipers = (engine_get_rook_attacks(info->king_square, pos->occupied[info->them]) &
+               (pos->pieces[info->them][PIECE_ROOK] | pos->pieces[info->them][PIECE_QUEEN])) |
+              (engine_get_bishop_attacks(info->king_square, pos->occupied[info->them]) &
+               (pos->pieces[info->them][PIECE_BISHOP] | pos->pieces[info->them][PIECE_QUEEN]));
+
+    while (snipers != 0ULL) {
+        int sniper = pop_lsb(&snipers);
+        Bitboard blockers = engine_get_between(info->king_square, sniper) & pos->all_occupied;
+
+        if (blockers != 0ULL && (blockers & (blockers - 1ULL)) == 0ULL) {
+            info->pinned |= blockers & pos->occupied[info->us];
+        }
+    }
+}
+
+/* Which subset of legal moves a generator call emits. */
+typedef enum GenMode {
+    GEN_ALL = 0,
+    GEN_CAPTURES = 1 /* captures plus queen promotions, for quiescence */
+} GenMode;
+
+/* Destinations a piece may legally reach given check and pin constraints. */
+static Bitboard legal_target_mask(const LegalityInfo* info, int from) {
+    if ((info->pinned & bb_square(from)) != 0ULL) {
+        return info->check_mask & engine_get_line(info->king_square, from);
+    }
+    return info->check_mask;
+}
+
+/* En passant removes two pawns from one rank, so it is verified by direct simulation. */
+static bool en_passant_is_legal(const Position* pos, const LegalityInfo* info, int from, int to) {
+    int cap_square = (info->us == SIDE_WHITE) ? (to - 8) : (to + 8);
+    Bitboard occupancy;
+
+    if (info->king_square < 0) {
+        return true;
+    }
+
+    occupancy = (pos->all_occupied ^ bb_square(from) ^ bb_square(cap_square)) | bb_square(to);
+    return (engine_attackers_to(pos, info->king_square, occupancy) &
+            pos->occupied[info->them] & ~bb_square(cap_square)) == 0ULL;
+}
+
+/* Emits a pawn move onto the last rank: all four pieces normally, only the queen for captures mode. */
+static void add_pawn_promotions(PackedMoveList* list, int from, int to, unsigned base_kind, GenMode mode) {
+    if (mode == GEN_CAPTURES) {
+        add_move(list, from, to, promotion_kind(base_kind, PIECE_QUEEN));
+    } else {
+        add_promotion_moves(list, from, to, base_kind);
+    }
+}
+
+/* Generates legal pawn moves for the side to move. */
+static void generate_pawn_moves(const Position* pos, const LegalityInfo* info, GenMode mode, PackedMoveList* list) {
+    Side us = info->us;
+    Side them = info->them;
     Bitboard pawns = pos->pieces[us][PIECE_PAWN];
+    int promote_rank = (us == SIDE_WHITE) ? 7 : 0;
 
     while (pawns != 0ULL) {
         int from = pop_lsb(&pawns);
         int file = from & 7;
         int rank = from >> 3;
+        Bitboard allowed = legal_target_mask(info, from);
 
         {
             int forward = (us == SIDE_WHITE) ? (from + 8) : (from - 8);
             if (forward >= 0 && forward < BOARD_SQUARES && ((pos->all_occupied & bb_square(forward)) == 0ULL)) {
-                int promote_rank = (us == SIDE_WHITE) ? 7 : 0;
-
                 if ((forward >> 3) == promote_rank) {
-                    add_promotion_moves(list, (uint8_t)from, (uint8_t)forward, MOVE_FLAG_NONE);
-                } else {
-                    add_move(list, (uint8_t)from, (uint8_t)forward, MOVE_FLAG_NONE, PIECE_NONE);
-
-                    {
-                        int start_rank = (us == SIDE_WHITE) ? 1 : 6;
-                        int double_forward = (us == SIDE_WHITE) ? (from + 16) : (from - 16);
-                        if (rank == start_rank && ((pos->all_occupied & bb_square(double_forward)) == 0ULL)) {
-                            add_move(list, (uint8_t)from, (uint8_t)double_forward, MOVE_FLAG_DOUBLE_PAWN, PIECE_NONE);
-                        }
+                    if ((allowed & bb_square(forward)) != 0ULL) {
+                        add_pawn_promotions(list, from, forward, MOVE_KIND_QUIET, mode);
                     }
-                }
-            }
-        }
+                } else if (mode == GEN_ALL) {
+                    int start_rank = (us == SIDE_WHITE) ? 1 : 6;
+                    int double_forward = (us == SIDE_WHITE) ? (from + 16) : (from - 16);
 
-        {
-            int cap_left = (us == SIDE_WHITE) ? (from + 7) : (from - 9);
-            if (file > 0 && cap_left >= 0 && cap_left < BOARD_SQUARES) {
-                bool is_capture = (pos->occupied[them] & bb_square(cap_left)) != 0ULL;
-                bool is_ep = cap_left == pos->en_passant_square;
-                if (is_capture || is_ep) {
-                    uint8_t flags = MOVE_FLAG_CAPTURE;
-                    if (is_ep) {
-                        flags = (uint8_t)(flags | MOVE_FLAG_EN_PASSANT);
+                    if ((allowed & bb_square(forward)) != 0ULL) {
+                        add_move(list, from, forward, MOVE_KIND_QUIET);
                     }
-
-                    if ((cap_left >> 3) == ((us == SIDE_WHITE) ? 7 : 0)) {
-                        add_promotion_moves(list, (uint8_t)from, (uint8_t)cap_left, flags);
-                    } else {
-                        add_move(list, (uint8_t)from, (uint8_t)cap_left, flags, PIECE_NONE);
+                    if (rank == start_rank &&
+                        ((pos->all_occupied & bb_square(double_forward)) == 0ULL) &&
+                        ((allowed & bb_square(double_forward)) != 0ULL)) {
+                        add_move(list, from, double_forward, MOVE_KIND_DOUBLE_PAWN);
                     }
                 }
             }
         }
 
-        {
-            int cap_right = (us == SIDE_WHITE) ? (from + 9) : (from - 7);
-            if (file < 7 && cap_right >= 0 && cap_right < BOARD_SQUARES) {
-                bool is_capture = (pos->occupied[them] & bb_square(cap_right)) != 0ULL;
-                bool is_ep = cap_right == pos->en_passant_square;
-                if (is_capture || is_ep) {
-                    uint8_t flags = MOVE_FLAG_CAPTURE;
-                    if (is_ep) {
-                        flags = (uint8_t)(flags | MOVE_FLAG_EN_PASSANT);
-                    }
+        for (int side_step = 0; side_step < 2; ++side_step) {
+            int target;
+            bool is_capture;
+            bool is_ep;
 
-                    if ((cap_right >> 3) == ((us == SIDE_WHITE) ? 7 : 0)) {
-                        add_promotion_moves(list, (uint8_t)from, (uint8_t)cap_right, flags);
-                    } else {
-                        add_move(list, (uint8_t)from, (uint8_t)cap_right, flags, PIECE_NONE);
-                    }
+            if (side_step == 0) {
+                if (file == 0) {
+                    continue;
+                }
+                target = (us == SIDE_WHITE) ? (from + 7) : (from - 9);
+            } else {
+                if (file == 7) {
+                    continue;
                 }
+                target = (us == SIDE_WHITE) ? (from + 9) : (from - 7);
+            }
+            if (target < 0 || target >= BOARD_SQUARES) {
+                continue;
+            }
+
+            is_capture = (pos->occupied[them] & bb_square(target) & allowed) != 0ULL;
+            is_ep = target == pos->en_passant_square && en_passant_is_legal(pos, info, from, target);
+            if (!is_capture && !is_ep) {
+                continue;
+            }
+
+            if (is_ep) {
+                add_move(list, from, target, MOVE_KIND_EN_PASSANT);
+            } else if ((target >> 3) == promote_rank) {
+                add_pawn_promotions(list, from, target, MOVE_KIND_CAPTURE, mode);
+            } else {
+                add_move(list, from, target, MOVE_KIND_CAPTURE);
             }
         }
     }
 }
 
-/* Generates all pseudo-legal knight moves for one side. */
-static void generate_knight_moves(const Position* pos, Side us, MoveList* list) {
-    Side them = (us == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
-    Bitboard knights = pos->pieces[us][PIECE_KNIGHT];
+/* Emits one move per destination bit, flagging captures of enemy pieces. */
+static void add_target_moves(const Position* pos, Side them, int from, Bitboard targets, PackedMoveList* list) {
+    while (targets != 0ULL) {
+        int to = pop_lsb(&targets);
+        unsigned kind = ((pos->occupied[them] & bb_square(to)) != 0ULL) ? MOVE_KIND_CAPTURE : MOVE_KIND_QUIET;
+        add_move(list, from, to, kind);
+    }
+}
+
+/* Destination squares allowed by the generation mode. */
+static Bitboard mode_target_mask(const Position* pos, const LegalityInfo* info, GenMode mode) {
+    return (mode == GEN_CAPTURES) ? pos->occupied[info->them] : ~pos->occupied[info->us];
+}
+
+/* Generates legal knight moves (a pinned knight can never move). */
+static void generate_knight_moves(const Position* pos, const LegalityInfo* info, GenMode mode, PackedMoveList* list) {
+    Bitboard knights = pos->pieces[info->us][PIECE_KNIGHT] & ~info->pinned;
+    Bitboard allowed = mode_target_mask(pos, info, mode) & info->check_mask;
 
     while (knights != 0ULL) {
         int from = pop_lsb(&knights);
-        Bitboard attacks = engine_get_knight_attacks(from) & ~pos->occupied[us];
-
-        while (attacks != 0ULL) {
-            int to = pop_lsb(&attacks);
-            uint8_t flags = ((pos->occupied[them] & bb_square(to)) != 0ULL) ? MOVE_FLAG_CAPTURE : MOVE_FLAG_NONE;
-            add_move(list, (uint8_t)from, (uint8_t)to, flags, PIECE_NONE);
-        }
+        Bitboard targets = engine_get_knight_attacks(from) & allowed;
+        add_target_moves(pos, info->them, from, targets, list);
     }
 }
 
-/* Generates pseudo-legal sliding moves for bishops/rooks/queens. */
-static void generate_slider_moves(const Position* pos, Side us, PieceType piece, MoveList* list) {
-    Side them = (us == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
-    Bitboard sliders = pos->pieces[us][piece];
+/* Generates legal sliding moves for bishops/rooks/queens. */
+static void generate_slider_moves(const Position* pos,
+                                  const LegalityInfo* info,
+                                  PieceType piece,
+                                  GenMode mode,
+                                  PackedMoveList* list) {
+    Bitboard sliders = pos->pieces[info->us][piece];
+    Bitboard allowed = mode_target_mask(pos, info, mode);
 
     while (sliders != 0ULL) {
         int from = pop_lsb(&sliders);
@@ -184,105 +291,127 @@ static void generate_slider_moves(const Position* pos, Side us, PieceType piece,
                       engine_get_rook_attacks(from, pos->all_occupied);
         }
 
-        attacks &= ~pos->occupied[us];
+        attacks &= allowed & legal_target_mask(info, from);
+        add_target_moves(pos, info->them, from, attacks, list);
+    }
+}
 
-        while (attacks != 0ULL) {
-            int to = pop_lsb(&attacks);
-            uint8_t flags = ((pos->occupied[them] & bb_square(to)) != 0ULL) ? MOVE_FLAG_CAPTURE : MOVE_FLAG_NONE;
-            add_move(list, (uint8_t)from, (uint8_t)to, flags, PIECE_NONE);
-        }
+/* True when every listed square is empty and none of them is attacked by the opponent. */
+static bool castle_path_clear(const Position* pos, Side them, Bitboard empty_mask, const int safe_squares[2]) {
+    if ((pos->all_occupied & empty_mask) != 0ULL) {
+        return false;
     }
+
+    return !engine_is_square_attacked(pos, safe_squares[0], them) &&
+           !engine_is_square_attacked(pos, safe_squares[1], them);
 }
 
-/* Generates pseudo-legal king moves, including castling checks. */
-static void generate_king_moves(const Position* pos, Side us, MoveList* list) {
-    Side them = (us == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
-    Bitboard king = pos->pieces[us][PIECE_KING];
-    int from = 0;
+/* Generates legal king moves, including castling (never while in check or in captures mode). */
+static void generate_king_moves(const Position* pos, const LegalityInfo* info, GenMode mode, PackedMoveList* list) {
+    Side us = info->us;
+    Side them = info->them;
+    int from = info->king_square;
 
-    if (king == 0ULL) {
+    if (from < 0) {
         return;
     }
 
-    from = bit_scan_forward(king);
-
     {
-        Bitboard attacks = engine_get_king_attacks(from) & ~pos->occupied[us];
-        while (attacks != 0ULL) {
-            int to = pop_lsb(&attacks);
-            uint8_t flags = ((pos->occupied[them] & bb_square(to)) != 0ULL) ? MOVE_FLAG_CAPTURE : MOVE_FLAG_NONE;
-            add_move(list, (uint8_t)from, (uint8_t)to, flags, PIECE_NONE);
+        /* The king is lifted off the board so sliders see through its old square. */
+        Bitboard occupancy = pos->all_occupied ^ bb_square(from);
+        Bitboard targets = engine_get_king_attacks(from) & mode_target_mask(pos, info, mode);
+
+        while (targets != 0ULL) {
+            int to = pop_lsb(&targets);
+            unsigned kind;
+
+            if ((engine_attackers_to(pos, to, occupancy) & pos->occupied[them]) != 0ULL) {
+                continue;
+            }
+
+            kind = ((pos->occupied[them] & bb_square(to)) != 0ULL) ? MOVE_KIND_CAPTURE : MOVE_KIND_QUIET;
+            add_move(list, from, to, kind);
         }
     }
 
-    if (us == SIDE_WHITE) {
-        if (from == 4 && (pos->castling_rights & CASTLE_WHITE_KING) != 0U) {
-            bool rook_present = (pos->pieces[SIDE_WHITE][PIECE_ROOK] & bb_square(7)) != 0ULL;
-            bool empty = ((pos->all_occupied & (bb_square(5) | bb_square(6))) == 0ULL);
-            bool safe = !engine_is_square_attacked(pos, 4, them) &&
-                        !engine_is_square_attacked(pos, 5, them) &&
-                        !engine_is_square_attacked(pos, 6, them);
-            if (rook_present && empty && safe) {
-                add_move(list, 4, 6, MOVE_FLAG_KING_CASTLE, PIECE_NONE);
-            }
+    if (info->checkers != 0ULL || mode == GEN_CAPTURES) {
+        return;
+    }
+
+    if (us == SIDE_WHITE && from == 4) {
+        static const int king_side_safe[2] = {5, 6};
+        static const int queen_side_safe[2] = {3, 2};
+
+        if ((pos->castling_rights & CASTLE_WHITE_KING) != 0U &&
+            (pos->pieces[SIDE_WHITE][PIECE_ROOK] & bb_square(7)) != 0ULL &&
+            castle_path_clear(pos, them, bb_square(5) | bb_square(6), king_side_safe)) {
+            add_move(list, 4, 6, MOVE_KIND_KING_CASTLE);
         }
 
-        if (from == 4 && (pos->castling_rights & CASTLE_WHITE_QUEEN) != 0U) {
-            bool rook_present = (pos->pieces[SIDE_WHITE][PIECE_ROOK] & bb_square(0)) != 0ULL;
-            bool empty = ((pos->all_occupied & (bb_square(1) | bb_square(2) | bb_square(3))) == 0ULL);
-            bool safe = !engine_is_square_attacked(pos, 4, them) &&
-                        !engine_is_square_attacked(pos, 3, them) &&
-                        !engine_is_square_attacked(pos, 2, them);
-            if (rook_present && empty && safe) {
-                add_move(list, 4, 2, MOVE_FLAG_QUEEN_CASTLE, PIECE_NONE);
-            }
+        if ((pos->castling_rights & CASTLE_WHITE_QUEEN) != 0U &&
+            (pos->pieces[SIDE_WHITE][PIECE_ROOK] & bb_square(0)) != 0ULL &&
+            castle_path_clear(pos, them, bb_square(1) | bb_square(2) | bb_square(3), queen_side_safe)) {
+            add_move(list, 4, 2, MOVE_KIND_QUEEN_CASTLE);
         }
-    } else {
-        if (from == 60 && (pos->castling_rights & CASTLE_BLACK_KING) != 0U) {
-            bool rook_present = (pos->pieces[SIDE_BLACK][PIECE_ROOK] & bb_square(63)) != 0ULL;
-            bool empty = ((pos->all_occupied & (bb_square(61) | bb_square(62))) == 0ULL);
-            bool safe = !engine_is_square_attacked(pos, 60, them) &&
-                        !engine_is_square_attacked(pos, 61, them) &&
-                        !engine_is_square_attacked(pos, 62, them);
-            if (rook_present && empty && safe) {
-                add_move(list, 60, 62, MOVE_FLAG_KING_CASTLE, PIECE_NONE);
-            }
+    } else if (us == SIDE_BLACK && from == 60) {
+        static const int king_side_safe[2] = {61, 62};
+        static const int queen_side_safe[2] = {59, 58};
+
+        if ((pos->castling_rights & CASTLE_BLACK_KING) != 0U &&
+            (pos->pieces[SIDE_BLACK][PIECE_ROOK] & bb_square(63)) != 0ULL &&
+            castle_path_clear(pos, them, bb_square(61) | bb_square(62), king_side_safe)) {
+            add_move(list, 60, 62, MOVE_KIND_KING_CASTLE);
         }
 
-        if (from == 60 && (pos->castling_rights & CASTLE_BLACK_QUEEN) != 0U) {
-            bool rook_present = (pos->pieces[SIDE_BLACK][PIECE_ROOK] & bb_square(56)) != 0ULL;
-            bool empty = ((pos->all_occupied & (bb_square(57) | bb_square(58) | bb_square(59))) == 0ULL);
-            bool safe = !engine_is_square_attacked(pos, 60, them) &&
-                        !engine_is_square_attacked(pos, 59, them) &&
-                        !engine_is_square_attacked(pos, 58, them);
-            if (rook_present && empty && safe) {
-                add_move(list, 60, 58, MOVE_FLAG_QUEEN_CASTLE, PIECE_NONE);
-            }
+        if ((pos->castling_rights & CASTLE_BLACK_QUEEN) != 0U &&
+            (pos->pieces[SIDE_BLACK][PIECE_ROOK] & bb_square(56)) != 0ULL &&
+            castle_path_clear(pos, them, bb_square(57) | bb_square(58) | bb_square(59), queen_side_safe)) {
+            add_move(list, 60, 58, MOVE_KIND_QUEEN_CASTLE);
         }
     }
 }
 
-/* Generates pseudo-legal move list before king-safety filtering. */
-static void generate_pseudo_legal_moves(const Position* pos, MoveList* list) {
-    Side us = pos->side_to_move;
-
-    list->count = 0;
-    generate_pawn_moves(pos, us, list);
-    generate_knight_moves(pos, us, list);
-    generate_slider_moves(pos, us, PIECE_BISHOP, list);
-    generate_slider_moves(pos, us, PIECE_ROOK, list);
-    generate_slider_moves(pos, us, PIECE_QUEEN, list);
-    generate_king_moves(pos, us, list);
+/* Adds or removes one piece, keeping occupancy, mailbox, zobrist/pawn keys and PST totals in step. */
+static void toggle_piece(Position* pos, Side side, PieceType piece, int square) {
+    Bitboard mask = bb_square(square);
+
+    pos->pieces[side][piece] ^= mask;
+    pos->occupied[side] ^= mask;
+    pos->all_occupied ^= mask;
+    if ((pos->pieces[side][piece] & mask) != 0ULL) {
+        pos->board[square] = (uint8_t)((side << 3) | piece);
+        pos->psq_mg += g_psq_mg[side][piece][square];
+        pos->psq_eg += g_psq_eg[side][piece][square];
+        pos->phase = (int16_t)(pos->phase + g_phase_weights[piece]);
+    } else {
+        pos->board[square] = (uint8_t)MAILBOX_EMPTY;
+        pos->psq_mg -= g_psq_mg[side][piece][square];
+        pos->psq_eg -= g_psq_eg[side][piece][square];
+        pos->phase = (int16_t)(pos->phase - g_phase_weights[piece]);
+    }
+    pos->zobrist_key ^= g_zobrist_piece[side][piece][square];
+    if (piece == PIECE_PAWN) {
+        pos->pawn_key ^= g_zobrist_piece[side][PIECE_PAWN][square];
+    }
 }
 
-/* Clears any piece from a side at one square. */
-static void clear_piece_at(Position* pos, Side side, int square) {
-    Bitboard mask = ~bb_square(square);
-
-    for (int piece = 0; piece < 6; ++piece) {
-        pos->pieces[side][piece] &= mask;
-    }
+#ifndef NDEBUG
+/* Debug-build cross-check of incrementally maintained occupancy, mailbox and hash. */
+static bool position_state_consistent(const Position* pos) {
+    Position rebuilt = *pos;
+
+    position_refresh_occupancy(&rebuilt);
+    return rebuilt.occupied[SIDE_WHITE] == pos->occupied[SIDE_WHITE] &&
+           rebuilt.occupied[SIDE_BLACK] == pos->occupied[SIDE_BLACK] &&
+           rebuilt.all_occupied == pos->all_occupied &&
+           memcmp(rebuilt.board, pos->board, sizeof(pos->board)) == 0 &&
+           rebuilt.pawn_key == pos->pawn_key &&
+           rebuilt.psq_mg == pos->psq_mg &&
+           rebuilt.psq_eg == pos->psq_eg &&
+           rebuilt.phase == pos->phase &&
+           position_compute_zobrist(pos) == pos->zobrist_key;
 }
+#endif
 
 /* Updates castling rights after king/rook moves or rook captures. */
 static void update_castling_rights(Position* pos, Side us, PieceType moved_piece, int from, int to) {
@@ -318,6 +447,129 @@ static void update_castling_rights(Position* pos, Side us, PieceType moved_piece
     }
 }
 
+/* Rook source/destination squares for a castling king destination. */
+static void castle_rook_squares(int king_to, int* rook_from, int* rook_to) {
+    switch (king_to) {
+        case 6:
+            *rook_from = 7;
+            *rook_to = 5;
+            break;
+        case 2:
+            *rook_from = 0;
+            *rook_to = 3;
+            break;
+        case 62:
+            *rook_from = 63;
+            *rook_to = 61;
+            break;
+        default:
+            *rook_from = 56;
+            *rook_to = 59;
+            break;
+    }
+}
+
+/*
+ * Board update shared by validated and trusted make-move paths. The move must
+ * already be known to be playable; undo (optional) receives the restore state.
+ */
+static void make_move_core(Position* pos, PackedMove move, PieceType moved_piece, MoveUndo* undo) {
+    Side us = pos->side_to_move;
+    Side them = (us == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
+    int from = PACKED_FROM(move);
+    int to = PACKED_TO(move);
+    unsigned kind = PACKED_KIND(move);
+    bool is_castle = PACKED_IS_CASTLE(move);
+    PieceType captured_piece = PIECE_NONE;
+
+    if (undo != NULL) {
+        undo->zobrist_key = pos->zobrist_key;
+        undo->pawn_key = pos->pawn_key;
+        undo->psq_mg = pos->psq_mg;
+        undo->psq_eg = pos->psq_eg;
+        undo->phase = pos->phase;
+        undo->halfmove_clock = pos->halfmove_clock;
+        undo->en_passant_square = pos->en_passant_square;
+        undo->castling_rights = pos->castling_rights;
+    }
+
+    /* Old castling/en-passant keys leave the hash; the new ones are added at the end. */
+    pos->zobrist_key ^= g_zobrist_castling[pos->castling_rights & 0x0F];
+    if (pos->en_passant_square >= 0 && pos->en_passant_square < BOARD_SQUARES) {
+        pos->zobrist_key ^= g_zobrist_ep_file[pos->en_passant_square & 7];
+    }
+
+    if (kind == MOVE_KIND_EN_PASSANT) {
+        int cap_square = (us == SIDE_WHITE) ? (to - 8) : (to + 8);
+        Side cap_side;
+        PieceType cap_piece;
+
+        if (cap_square >= 0 && cap_square < BOARD_SQUARES &&
+            position_piece_at(pos, cap_square, &cap_side, &cap_piece) && cap_side == them) {
+            toggle_piece(pos, them, cap_piece, cap_square);
+            captured_piece = cap_piece;
+        }
+    } else if (!is_castle) {
+        Side cap_side;
+        PieceType cap_piece;
+
+        if (position_piece_at(pos, to, &cap_side, &cap_piece) && cap_side == them) {
+            toggle_piece(pos, them, cap_piece, to);
+            captured_piece = cap_piece;
+        }
+    }
+
+    toggle_piece(pos, us, moved_piece, from);
+
+    {
+        PieceType placed_piece = moved_piece;
+
+        if ((kind & MOVE_KIND_PROMOTION) != 0U && moved_piece == PIECE_PAWN) {
+            placed_piece = PACKED_PROMOTION_PIECE(move);
+        }
+
+        toggle_piece(pos, us, placed_piece, to);
+    }
+
+    if (is_castle) {
+        int rook_from;
+        int rook_to;
+
+        castle_rook_squares(to, &rook_from, &rook_to);
+        toggle_piece(pos, us, PIECE_ROOK, rook_from);
+        toggle_piece(pos, us, PIECE_ROOK, rook_to);
+    }
+
+    update_castling_rights(pos, us, moved_piece, from, to);
+    pos->zobrist_key ^= g_zobrist_castling[pos->castling_rights & 0x0F];
+
+    if (kind == MOVE_KIND_DOUBLE_PAWN && moved_piece == PIECE_PAWN) {
+        pos->en_passant_square = (int8_t)((us == SIDE_WHITE) ? (to - 8) : (to + 8));
+        pos->zobrist_key ^= g_zobrist_ep_file[pos->en_passant_square & 7];
+    } else {
+        pos->en_passant_square = -1;
+    }
+
+    if (moved_piece == PIECE_PAWN || captured_piece != PIECE_NONE || kind == MOVE_KIND_EN_PASSANT) {
+        pos->halfmove_clock = 0;
+    } else {
+        pos->halfmove_clock++;
+    }
+
+    if (us == SIDE_BLACK) {
+        pos->fullmove_number++;
+    }
+
+    pos->side_to_move = them;
+    pos->zobrist_key ^= g_zobrist_side;
+
+    if (undo != NULL) {
+        undo->captured_piece = (uint8_t)captured_piece;
+    }
+
+    assert(position_state_consistent(pos));
+}
+
 /* Applies move without legality re-check (used by search and legal filtering). */
 static bool apply_move_internal(Position* pos, Move move) {
     Side us = pos->side_to_move;
@@ -325,7 +577,6 @@ static bool apply_move_internal(Position* pos, Move move) {
     Side found_side;
     PieceType moved_piece;
     bool is_castle = false;
-    bool is_capture = false;
     int castle_rook_from = -1;
     int castle_rook_to = -1;
     int castle_king_mid = -1;
@@ -414,88 +665,307 @@ static bool apply_move_internal(Position* pos, Move move) {
         }
     }
 
-    if (!is_castle && (move.flags & MOVE_FLAG_EN_PASSANT) != 0U) {
-        int cap_square = (us == SIDE_WHITE) ? (move.to - 8) : (move.to + 8);
-        if (cap_square < 0 || cap_square >= BOARD_SQUARES) {
-            return false;
-        }
+    if (!is_castle && (pos->occupied[us] & bb_square(move.to)) != 0ULL) {
+        return false;
+    }
 
-        clear_piece_at(pos, them, cap_square);
-        is_capture = true;
-    } else if (!is_castle) {
-        Side cap_side;
-        PieceType cap_piece;
+    make_move_core(pos, engine_pack_move(move), moved_piece, NULL);
+    return true;
+}
 
-        if (position_piece_at(pos, move.to, &cap_side, &cap_piece) && cap_side == them) {
-            clear_piece_at(pos, them, move.to);
-            is_capture = true;
-        }
+/* Packs a public move; flags pick the kind and an invalid promotion piece becomes a queen. */
+PackedMove engine_pack_move(Move move) {
+    unsigned kind = MOVE_KIND_QUIET;
+
+    if ((move.flags & MOVE_FLAG_KING_CASTLE) != 0U) {
+        kind = MOVE_KIND_KING_CASTLE;
+    } else if ((move.flags & MOVE_FLAG_QUEEN_CASTLE) != 0U) {
+        kind = MOVE_KIND_QUEEN_CASTLE;
+    } else if ((move.flags & MOVE_FLAG_PROMOTION) != 0U) {
+        PieceType piece = (move.promotion >= PIECE_KNIGHT && move.promotion <= PIECE_QUEEN)
+                              ? (PieceType)move.promotion
+                              : PIECE_QUEEN;
+        kind = promotion_kind(((move.flags & MOVE_FLAG_CAPTURE) != 0U) ? MOVE_KIND_CAPTURE : MOVE_KIND_QUIET, piece);
+    } else if ((move.flags & MOVE_FLAG_EN_PASSANT) != 0U) {
+        kind = MOVE_KIND_EN_PASSANT;
+    } else if ((move.flags & MOVE_FLAG_DOUBLE_PAWN) != 0U) {
+        kind = MOVE_KIND_DOUBLE_PAWN;
+    } else if ((move.flags & MOVE_FLAG_CAPTURE) != 0U) {
+        kind = MOVE_KIND_CAPTURE;
     }
 
-    pos->pieces[us][moved_piece] &= ~bb_square(move.from);
+    return PACKED_MOVE(move.from & 63U, move.to & 63U, kind);
+}
 
-    {
-        PieceType placed_piece = moved_piece;
+/* Expands a packed move into the public struct used by the GUI, network and API callers. */
+Move engine_unpack_move(PackedMove move) {
+    static const uint8_t kind_flags[8] = {
+        MOVE_FLAG_NONE,
+        MOVE_FLAG_DOUBLE_PAWN,
+        MOVE_FLAG_KING_CASTLE,
+        MOVE_FLAG_QUEEN_CASTLE,
+        MOVE_FLAG_CAPTURE,
+        MOVE_FLAG_CAPTURE | MOVE_FLAG_EN_PASSANT,
+        MOVE_FLAG_NONE,
+        MOVE_FLAG_NONE
+    };
+    unsigned kind = PACKED_KIND(move);
+    Move out;
+
+    out.from = (uint8_t)PACKED_FROM(move);
+    out.to = (uint8_t)PACKED_TO(move);
+    if ((kind & MOVE_KIND_PROMOTION) != 0U) {
+        out.flags = (uint8_t)(MOVE_FLAG_PROMOTION | (((kind & MOVE_KIND_CAPTURE) != 0U) ? MOVE_FLAG_CAPTURE : 0U));
+        out.promotion = (uint8_t)PACKED_PROMOTION_PIECE(move);
+    } else {
+        out.flags = kind_flags[kind & 7U];
+        out.promotion = PIECE_NONE;
+    }
+    return out;
+}
 
-        if ((move.flags & MOVE_FLAG_PROMOTION) != 0U && moved_piece == PIECE_PAWN) {
-            if (move.promotion >= PIECE_KNIGHT && move.promotion <= PIECE_QUEEN) {
-                placed_piece = (PieceType)move.promotion;
-            } else {
-                placed_piece = PIECE_QUEEN;
-            }
-        }
+/* Runs every piece generator for one mode; in double check only the king may move. */
+static void generate_moves(const Position* pos, const LegalityInfo* info, GenMode mode, PackedMoveList* list) {
+    list->count = 0;
+    if (info->check_mask != 0ULL) {
+        generate_pawn_moves(pos, info, mode, list);
+        generate_knight_moves(pos, info, mode, list);
+        generate_slider_moves(pos, info, PIECE_BISHOP, mode, list);
+        generate_slider_moves(pos, info, PIECE_ROOK, mode, list);
+        generate_slider_moves(pos, info, PIECE_QUEEN, mode, list);
+    }
+    generate_king_moves(pos, info, mode, list);
+}
 
-        pos->pieces[us][placed_piece] |= bb_square(move.to);
+/* Converts an internal list to the public representation. */
+static void unpack_move_list(const PackedMoveList* packed, MoveList* list) {
+    list->count = packed->count;
+    for (int i = 0; i < packed->count; ++i) {
+        list->moves[i] = engine_unpack_move(packed->moves[i]);
     }
+}
 
-    if (is_castle) {
-        pos->pieces[us][PIECE_ROOK] &= ~bb_square(castle_rook_from);
-        pos->pieces[us][PIECE_ROOK] |= bb_square(castle_rook_to);
+/* Generates fully legal moves directly from pin and check-evasion masks. */
+void engine_generate_legal_packed(const Position* pos, PackedMoveList* list) {
+    LegalityInfo info;
+
+    compute_legality_info(pos, &info);
+    generate_moves(pos, &info, GEN_ALL, list);
+}
+
+/* Generates legal captures (including en passant) and queen promotions only. */
+void engine_generate_captures_packed(const Position* pos, PackedMoveList* list) {
+    LegalityInfo info;
+
+    compute_legality_info(pos, &info);
+    generate_moves(pos, &info, GEN_CAPTURES, list);
+}
+
+/* Generates every legal reply to check; the list is empty when the side to move is not in check. */
+void engine_generate_evasions_packed(const Position* pos, PackedMoveList* list) {
+    LegalityInfo info;
+
+    compute_legality_info(pos, &info);
+    if (info.checkers == 0ULL) {
+        list->count = 0;
+        return;
     }
+    generate_moves(pos, &info, GEN_ALL, list);
+}
+
+void generate_legal_moves(const Position* pos, MoveList* list) {
+    PackedMoveList packed;
 
-    update_castling_rights(pos, us, moved_piece, move.from, move.to);
+    engine_generate_legal_packed(pos, &packed);
+    unpack_move_list(&packed, list);
+}
 
-    if ((move.flags & MOVE_FLAG_DOUBLE_PAWN) != 0U && moved_piece == PIECE_PAWN) {
-        pos->en_passant_square = (int8_t)((us == SIDE_WHITE) ? (move.to - 8) : (move.to + 8));
-    } else {
-        pos->en_passant_square = -1;
+void generate_captures(const Position* pos, MoveList* list) {
+    PackedMoveList packed;
+
+    engine_generate_captures_packed(pos, &packed);
+    unpack_move_list(&packed, list);
+}
+
+void generate_evasions(const Position* pos, MoveList* list) {
+    PackedMoveList packed;
+
+    engine_generate_evasions_packed(pos, &packed);
+    unpack_move_list(&packed, list);
+}
+
+/* Checks an untrusted move (e.g. a TT hint) by regenerating only the moving piece's moves. */
+bool engine_packed_is_legal(const Position* pos, PackedMove move) {
+    LegalityInfo info;
+    PackedMoveList list;
+    int from = PACKED_FROM(move);
+    uint8_t code;
+    PieceType piece;
+
+    if (from == PACKED_TO(move)) {
+        return false;
     }
 
-    if (moved_piece == PIECE_PAWN || is_capture) {
-        pos->halfmove_clock = 0;
-    } else {
-        pos->halfmove_clock++;
+    code = pos->board[from];
+    if (code == MAILBOX_EMPTY || (Side)(code >> 3) != pos->side_to_move) {
+        return false;
     }
+    piece = (PieceType)(code & 7U);
 
-    if (us == SIDE_BLACK) {
-        pos->fullmove_number++;
+    compute_legality_info(pos, &info);
+    if (piece != PIECE_KING && info.check_mask == 0ULL) {
+        return false;
     }
 
-    pos->side_to_move = them;
-    position_refresh_occupancy(pos);
-    pos->zobrist_key = position_compute_zobrist(pos);
+    list.count = 0;
+    switch (piece) {
+        case PIECE_PAWN:
+            generate_pawn_moves(pos, &info, GEN_ALL, &list);
+            break;
+        case PIECE_KNIGHT:
+            generate_knight_moves(pos, &info, GEN_ALL, &list);
+            break;
+        case PIECE_KING:
+            generate_king_moves(pos, &info, GEN_ALL, &list);
+            break;
+        default:
+            generate_slider_moves(pos, &info, piece, GEN_ALL, &list);
+            break;
+    }
+
+    for (int i = 0; i < list.count; ++i) {
+        if (list.moves[i] == move) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool engine_is_move_legal(const Position* pos, Move move) {
+    if (move.from >= BOARD_SQUARES || move.to >= BOARD_SQUARES) {
+        return false;
+    }
+    return engine_packed_is_legal(pos, engine_pack_move(move));
+}
+
+/* Trusted in-place make for moves produced by the legal generators (search/perft). */
+bool engine_make_packed(Position* pos, PackedMove move, MoveUndo* undo) {
+    uint8_t code = pos->board[PACKED_FROM(move)];
+
+    if (code == MAILBOX_EMPTY || (Side)(code >> 3) != pos->side_to_move) {
+        return false;
+    }
 
+    make_move_core(pos, move, (PieceType)(code & 7U), undo);
     return true;
 }
 
-/* Generates legal moves by filtering pseudo-legal moves that expose own king. */
-void generate_legal_moves(const Position* pos, MoveList* list) {
-    MoveList pseudo;
-    Side moving_side = pos->side_to_move;
+/* Reverts engine_make_packed using its undo record. */
+void engine_unmake_packed(Position* pos, PackedMove move, const MoveUndo* undo) {
+    Side them = pos->side_to_move;
+    Side us = (them == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
+    int from = PACKED_FROM(move);
+    int to = PACKED_TO(move);
+    Bitboard from_mask = bb_square(from);
+    Bitboard to_mask = bb_square(to);
+    uint8_t code = pos->board[to];
+    PieceType placed_piece;
+    PieceType moved_piece;
 
-    generate_pseudo_legal_moves(pos, &pseudo);
-    list->count = 0;
+    if (code == MAILBOX_EMPTY) {
+        return;
+    }
+    placed_piece = (PieceType)(code & 7U);
+    moved_piece = PACKED_IS_PROMOTION(move) ? PIECE_PAWN : placed_piece;
+
+    pos->pieces[us][placed_piece] ^= to_mask;
+    pos->pieces[us][moved_piece] ^= from_mask;
+    pos->occupied[us] ^= from_mask | to_mask;
+    pos->board[to] = MAILBOX_EMPTY;
+    pos->board[from] = (uint8_t)((us << 3) | moved_piece);
+
+    if (PACKED_IS_CASTLE(move)) {
+        int rook_from;
+        int rook_to;
+        Bitboard rook_mask;
+
+        castle_rook_squares(to, &rook_from, &rook_to);
+        rook_mask = bb_square(rook_from) | bb_square(rook_to);
+        pos->pieces[us][PIECE_ROOK] ^= rook_mask;
+        pos->occupied[us] ^= rook_mask;
+        pos->board[rook_to] = MAILBOX_EMPTY;
+        pos->board[rook_from] = (uint8_t)((us << 3) | PIECE_ROOK);
+    }
 
-    for (int i = 0; i < pseudo.count; ++i) {
-        Position next = *pos;
-        if (!apply_move_internal(&next, pseudo.moves[i])) {
-            continue;
-        }
+    if (undo->captured_piece != PIECE_NONE) {
+        int cap_square = to;
 
-        if (!engine_in_check(&next, moving_side) && list->count < MAX_MOVES) {
-            list->moves[list->count++] = pseudo.moves[i];
+        if (PACKED_KIND(move) == MOVE_KIND_EN_PASSANT) {
+            cap_square = (us == SIDE_WHITE) ? (to - 8) : (to + 8);
         }
+        pos->pieces[them][undo->captured_piece] |= bb_square(cap_square);
+        pos->occupied[them] |= bb_square(cap_square);
+        pos->board[cap_square] = (uint8_t)((them << 3) | undo->captured_piece);
+    }
+
+    pos->all_occupied = pos->occupied[SIDE_WHITE] | pos->occupied[SIDE_BLACK];
+    pos->side_to_move = us;
+    if (us == SIDE_BLACK) {
+        pos->fullmove_number--;
+    }
+    pos->zobrist_key = undo->zobrist_key;
+    pos->pawn_key = undo->pawn_key;
+    pos->psq_mg = undo->psq_mg;
+    pos->psq_eg = undo->psq_eg;
+    pos->phase = undo->phase;
+    pos->halfmove_clock = undo->halfmove_clock;
+    pos->en_passant_square = undo->en_passant_square;
+    pos->castling_rights = undo->castling_rights;
+
+    assert(position_state_consistent(pos));
+}
+
+bool engine_make_move_fast(Position* pos, Move move, MoveUndo* undo) {
+    return engine_make_packed(pos, engine_pack_move(move), undo);
+}
+
+void engine_unmake_move(Position* pos, Move move, const MoveUndo* undo) {
+    engine_unmake_packed(pos, engine_pack_move(move), undo);
+}
+
+/* Passes the turn in place (null-move pruning); engine_unmake_null_move reverts it. */
+void engine_make_null_move(Position* pos, MoveUndo* undo) {
+    undo->zobrist_key = pos->zobrist_key;
+    undo->pawn_key = pos->pawn_key;
+    undo->psq_mg = pos->psq_mg;
+    undo->psq_eg = pos->psq_eg;
+    undo->phase = pos->phase;
+    undo->halfmove_clock = pos->halfmove_clock;
+    undo->en_passant_square = pos->en_passant_square;
+    undo->castling_rights = pos->castling_rights;
+    undo->captured_piece = PIECE_NONE;
+
+    if (pos->en_passant_square >= 0) {
+        pos->zobrist_key ^= g_zobrist_ep_file[pos->en_passant_square & 7];
+    }
+    pos->en_passant_square = -1;
+    pos->halfmove_clock++;
+    if (pos->side_to_move == SIDE_BLACK) {
+        pos->fullmove_number++;
     }
+    pos->side_to_move = (pos->side_to_move == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
+    pos->zobrist_key ^= g_zobrist_side;
+}
+
+void engine_unmake_null_move(Position* pos, const MoveUndo* undo) {
+    pos->side_to_move = (pos->side_to_move == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
+    if (pos->side_to_move == SIDE_BLACK) {
+        pos->fullmove_number--;
+    }
+    pos->zobrist_key = undo->zobrist_key;
+    pos->halfmove_clock = undo->halfmove_clock;
+    pos->en_passant_square = undo->en_passant_square;
+    pos->castling_rights = undo->castling_rights;
 }
 
 /* Applies a move without generating legal list. */
@@ -526,3 +996,96 @@ bool engine_in_check(const Position* pos, Side side) {
 
     return engine_is_square_attacked(pos, king_square, (side == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE);
 }
+
+/* Piece values for exchange evaluation; kept local so SEE is independent of eval tuning. */
+static const int g_see_values[6] = {100, 325, 325, 500, 975, 20000};
+
+/* Least valuable piece of `side` within `attackers`; returns its type and square, or PIECE_NONE. */
+static PieceType see_least_valuable(const Position* pos, Bitboard attackers, Side side, Bitboard* out_square) {
+    for (int piece = PIECE_PAWN; piece <= PIECE_KING; ++piece) {
+        Bitboard subset = attackers & pos->pieces[side][piece];
+
+        if (subset != 0ULL) {
+            *out_square = subset & (0ULL - subset);
+            return (PieceType)piece;
+        }
+    }
+    return PIECE_NONE;
+}
+
+/*
+ * Static exchange evaluation: material balance for the mover after the best sequence of recaptures on
+ * the target square. Sliders hidden behind a capturer are re-discovered after each removal (x-rays);
+ * pins are ignored, and a king only recaptures when the square is no longer defended.
+ */
+int engine_see_packed(const Position* pos, PackedMove move) {
+    int gain[32];
+    int depth = 0;
+    int from = PACKED_FROM(move);
+    int to = PACKED_TO(move);
+    uint8_t mover = pos->board[from];
+    Side side;
+    PieceType attacker;
+    Bitboard occupancy = pos->all_occupied;
+    Bitboard diagonal;
+    Bitboard straight;
+    Bitboard attackers;
+    Bitboard from_square = bb_square(from);
+
+    if (mover == MAILBOX_EMPTY) {
+        return 0;
+    }
+    side = (Side)(mover >> 3);
+    attacker = (PieceType)(mover & 7U);
+
+    if (PACKED_KIND(move) == MOVE_KIND_EN_PASSANT) {
+        gain[0] = g_see_values[PIECE_PAWN];
+        occupancy ^= bb_square(to + ((side == SIDE_WHITE) ? -8 : 8));
+    } else {
+        gain[0] = (pos->board[to] != MAILBOX_EMPTY) ? g_see_values[pos->board[to] & 7U] : 0;
+    }
+    if (PACKED_IS_PROMOTION(move)) {
+        attacker = PACKED_PROMOTION_PIECE(move);
+        gain[0] += g_see_values[attacker] - g_see_values[PIECE_PAWN];
+    }
+
+    diagonal = pos->pieces[SIDE_WHITE][PIECE_BISHOP] | pos->pieces[SIDE_BLACK][PIECE_BISHOP] |
+               pos->pieces[SIDE_WHITE][PIECE_QUEEN] | pos->pieces[SIDE_BLACK][PIECE_QUEEN];
+    straight = pos->pieces[SIDE_WHITE][PIECE_ROOK] | pos->pieces[SIDE_BLACK][PIECE_ROOK] |
+               pos->pieces[SIDE_WHITE][PIECE_QUEEN] | pos->pieces[SIDE_BLACK][PIECE_QUEEN];
+    attackers = engine_attackers_to(pos, to, occupancy);
+
+    do {
+        depth++;
+        /* Speculative score if the piece now standing on `to` gets taken next. */
+        gain[depth] = g_see_values[attacker] - gain[depth - 1];
+        if ((-gain[depth - 1] > gain[depth] ? -gain[depth - 1] : gain[depth]) < 0) {
+            break;
+        }
+
+        occupancy ^= from_square;
+        if (attacker == PIECE_PAWN || attacker == PIECE_BISHOP || attacker == PIECE_QUEEN) {
+            attackers |= engine_get_bishop_attacks(to, occupancy) & diagonal;
+        }
+        if (attacker == PIECE_ROOK || attacker == PIECE_QUEEN) {
+            attackers |= engine_get_rook_attacks(to, occupancy) & straight;
+        }
+        attackers &= occupancy;
+
+        side = (side == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
+        attacker = see_least_valuable(pos, attackers & pos->occupied[side], side, &from_square);
+        if (attacker == PIECE_KING &&
+            (attackers & pos->occupied[(side == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE]) != 0ULL) {
+            attacker = PIECE_NONE;
+        }
+    } while (attacker != PIECE_NONE && depth < 31);
+
+    while (--depth > 0) {
+        gain[depth - 1] = -((-gain[depth - 1] > gain[depth]) ? -gain[depth - 1] : gain[depth]);
+    }
+    return gain[0];
+}
+
+int engine_see(const Position* pos, Move move) {
+    return engine_see_packed(pos, engine_pack_move(move));
+}
@@ -1,19 +1,39 @@
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
 #include "engine.h"
+#include "engine_internal.h"
+#include "threading.h"
 
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #ifdef _MSC_VER
 #include <intrin.h>
 #endif
 
-#ifdef _WIN32
-#include <windows.h>
-#else
-#include <sys/time.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#define CHESS_TT_USE_MMAP 1
 #endif
 
-/* Transposition-table size (must be power-of-two for mask indexing). */
-#define TT_SIZE (1U << 21)
+/* Transposition-table geometry; bucket count is a power of two for mask indexing. */
+#define TT_DEFAULT_SIZE_MB 32
+#define TT_MAX_SIZE_MB 65536
+#define TT_BUCKET_SLOTS 4
+#define TT_BUCKET_BYTES 64
+#define TT_HUGE_PAGE_BYTES (2U * 1024U * 1024U)
+#define TT_CLEAR_SLICE_MB 16
+
+/* Per-thread pawn hash size (entries, power of two). */
+#define PAWN_HASH_ENTRIES 1024
+
+/* Shared static-eval cache: one 64-bit word per entry, key high bits | 16-bit eval. */
+#define EVAL_CACHE_ENTRIES (1U << 16)
+#define EVAL_CACHE_KEY_MASK 0xFFFFFFFFFFFF0000ULL
 
 /* Search score sentinels. */
 #define INF_SCORE 300000
@@ -23,6 +43,7 @@
 /* Search limits and internal stack caps. */
 #define SEARCH_MIN_DEPTH 1
 #define SEARCH_MAX_DEPTH 18
+#define SEARCH_MAX_THREADS 64
 #define MAX_SEARCH_PLY 128
 #define MAX_HISTORY_PLY 256
 #define ASPIRATION_BASE_WINDOW 35
@@ -45,29 +66,81 @@ typedef enum TTFlag {
     TT_FLAG_UPPER = 2
 } TTFlag;
 
-/* One transposition-table entry. */
+/*
+ * One 16-byte transposition-table slot. `data` packs score, move, depth and the
+ * generation/bound byte; `key_xor` stores zobrist ^ data, so a slot torn by two
+ * concurrent writers fails verification instead of returning mixed fields.
+ */
 typedef struct TTEntry {
-    uint64_t key;
-    int depth;
-    int score;
-    uint8_t generation;
-    uint8_t flag;
-    Move best_move;
+    _Atomic uint64_t key_xor;
+    _Atomic uint64_t data;
 } TTEntry;
 
-/* Shared recursive-search context. */
+/* Four slots per 64-byte cache line; a probe touches exactly one line. */
+typedef struct TTBucket {
+    _Alignas(TT_BUCKET_BYTES) TTEntry entries[TT_BUCKET_SLOTS];
+} TTBucket;
+
+/* One thread's share of a parallel table clear. */
+typedef struct TTClearSlice {
+    void* start;
+    size_t bytes;
+} TTClearSlice;
+
+/* Unpacked view of one slot. */
+typedef struct TTData {
+    int score;
+    PackedMove best_move;
+    int depth;
+    uint8_t gen_flag;
+} TTData;
+
+#define TT_GENERATION_MASK 0x3FU
+#define TT_GEN_FLAG(generation, flag) ((uint8_t)((((generation) & TT_GENERATION_MASK) << 2) | ((flag) & 3U)))
+#define TT_ENTRY_FLAG(entry) ((entry)->gen_flag & 3U)
+#define TT_ENTRY_GENERATION(entry) ((uint8_t)((entry)->gen_flag >> 2))
+
+/*
+ * Cached pawn-structure terms for one pawn_key. Files are stored as "has a pawn"
+ * masks so an all-zero slot is exactly the entry for the pawnless key 0.
+ */
+typedef struct PawnHashEntry {
+    uint64_t key;
+    int16_t score[2];
+    uint8_t pawn_files[2];
+} PawnHashEntry;
+
+/*
+ * Per-thread recursive-search context; engine owns the TT and eval cache all workers share,
+ * shared_stop lets the main thread halt Lazy SMP helpers
+ * and abort_flag (NULL for plain search_best_move) lets a SearchHandle owner cancel the search.
+ * While *ponder_flag is raised the time limit is ignored; the clock still runs from time.start_ms.
+ * limits.max_nodes is enforced exactly on the main thread's node count.
+ */
 typedef struct SearchContext {
+    Engine* engine;
     SearchLimits limits;
-    uint64_t start_ms;
+    TimeManager time;
     uint64_t nodes;
     bool stop;
+    atomic_bool* shared_stop;
+    atomic_bool* abort_flag;
+    atomic_bool* ponder_flag;
+    int thread_id;
     uint8_t generation;
 
     uint64_t path_keys[MAX_HISTORY_PLY];
     int path_len;
 
-    Move killer_moves[MAX_SEARCH_PLY][2];
+    PackedMove killer_moves[MAX_SEARCH_PLY][2];
     int history[2][BOARD_SQUARES][BOARD_SQUARES];
+
+    PawnHashEntry pawn_table[PAWN_HASH_ENTRIES];
+    uint64_t pawn_probes;
+    uint64_t pawn_hits;
+    uint64_t eval_probes;
+    uint64_t eval_hits;
+    uint64_t qnodes;
 } SearchContext;
 
 typedef struct OpeningBookSeed {
@@ -81,18 +154,36 @@ typedef struct OpeningBookEntry {
     int weight;
 } OpeningBookEntry;
 
-static TTEntry g_tt[TT_SIZE];
+/*
+ * Mutable search state of one engine instance. The table is allocated on first use
+ * (tt == NULL until then); tt_generation ages entries across this instance's searches.
+ */
+struct Engine {
+    TTBucket* tt;
+    void* tt_block;
+    size_t tt_block_bytes;
+    bool tt_mapped;
+    bool tt_huge_pages;
+    uint64_t tt_bucket_mask;
+    int tt_size_mb;
+    uint8_t tt_generation;
+    _Atomic uint64_t eval_cache[EVAL_CACHE_ENTRIES];
+};
+
+/* Backs the instance-free API (search_best_move, engine_set_hash_size, ...). */
+static Engine g_default_engine = {.tt_size_mb = TT_DEFAULT_SIZE_MB, .tt_generation = 1};
+
+/* Built once by engine_init and read-only afterwards, so every instance shares it. */
 static OpeningBookEntry g_opening_book[OPENING_BOOK_MAX_ENTRIES];
 static int g_opening_book_count = 0;
 static bool g_opening_book_ready = false;
-static uint8_t g_tt_generation = 1;
 
 /* Capture ordering values (king remains very high for MVV/LVA ranking). */
 static const int g_capture_values[6] = {100, 320, 330, 500, 900, 20000};
 /* Evaluation values (king excluded to avoid giant cancelling constants). */
 static const int g_eval_values[6] = {100, 320, 330, 500, 900, 0};
 /* Game-phase interpolation weights (max total = 24). */
-static const int g_phase_weights[6] = {0, 1, 1, 2, 4, 0};
+const int g_phase_weights[6] = {0, 1, 1, 2, 4, 0};
 
 /* Midgame PST values from White perspective (a1..h8). */
 static const int g_pst_mg[6][64] = {
@@ -234,6 +325,9 @@ static const int g_pst_eg[6][64] = {
     }
 };
 
+int32_t g_psq_mg[2][6][BOARD_SQUARES];
+int32_t g_psq_eg[2][6][BOARD_SQUARES];
+
 /* Curated practical opening lines (UCI format) with relative popularity weights. */
 static const OpeningBookSeed g_opening_book_seeds[] = {
     {"e2e4 e7e5 g1f3 b8c6 f1b5 a7a6 b5a4 g8f6 e1g1 f8e7", 90},
@@ -346,11 +440,6 @@ static Bitboard bb_square(int square) {
     return 1ULL << square;
 }
 
-/* Returns full file mask (a-file when file = 0). */
-static Bitboard file_mask(int file) {
-    return 0x0101010101010101ULL << file;
-}
-
 /* True when side still has at least one piece other than king/pawns. */
 static bool side_has_non_pawn_material(const Position* pos, Side side) {
     return (pos->pieces[side][PIECE_KNIGHT] |
@@ -415,8 +504,8 @@ static bool parse_next_uci_token(const char** cursor, char out[6]) {
     return len >= 4 && len <= 5;
 }
 
-/* Builds key->move opening map from curated opening seeds. */
-static void opening_book_build(void) {
+/* Builds key->move opening map from curated opening seeds (called by engine_init). */
+void engine_init_opening_book(void) {
     if (g_opening_book_ready) {
         return;
     }
@@ -493,7 +582,6 @@ static bool opening_book_pick_move(const Position* pos, int randomness, Move* ou
         return false;
     }
 
-    opening_book_build();
     if (g_opening_book_count <= 0) {
         return false;
     }
@@ -588,17 +676,6 @@ static int mirror_square(int square) {
     return square ^ 56;
 }
 
-/* Monotonic-ish millisecond timestamp for search time control. */
-static uint64_t now_ms(void) {
-#ifdef _WIN32
-    return (uint64_t)GetTickCount64();
-#else
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (uint64_t)tv.tv_sec * 1000ULL + (uint64_t)(tv.tv_usec / 1000ULL);
-#endif
-}
-
 /* Converts mate score for TT storage so distance-to-mate remains stable by ply. */
 static int score_to_tt(int score, int ply) {
     if (score > MATE_BOUND) {
@@ -621,6 +698,243 @@ static int score_from_tt(int score, int ply) {
     return score;
 }
 
+/* Releases the current table block (mmap or malloc backed). */
+static void tt_release(Engine* engine) {
+#ifdef CHESS_TT_USE_MMAP
+    if (engine->tt_mapped) {
+        munmap(engine->tt_block, engine->tt_block_bytes);
+    } else {
+        free(engine->tt_block);
+    }
+#else
+    free(engine->tt_block);
+#endif
+    engine->tt_block = NULL;
+    engine->tt_block_bytes = 0U;
+    engine->tt_mapped = false;
+    engine->tt = NULL;
+    engine->tt_bucket_mask = 0ULL;
+}
+
+/* Zeroes one slice of the table; run concurrently by tt_clear. */
+static void* tt_clear_slice(void* arg) {
+    TTClearSlice* slice = (TTClearSlice*)arg;
+
+    memset(slice->start, 0, slice->bytes);
+    return NULL;
+}
+
+/*
+ * Zeroes the table, splitting large tables across threads (at least
+ * TT_CLEAR_SLICE_MB each). This is also the first touch after allocation,
+ * so page faults are spread over the same threads.
+ */
+static void tt_clear(Engine* engine) {
+    ChessFuture* futures[SEARCH_MAX_THREADS];
+    TTClearSlice slices[SEARCH_MAX_THREADS];
+    ChessThreadPool* pool = chess_pool_shared();
+    size_t total = (size_t)((engine->tt_bucket_mask + 1ULL) * sizeof(TTBucket));
+    size_t buckets_per_slice;
+    int thread_count = chess_cpu_count();
+    int max_by_size = (int)(total / ((size_t)TT_CLEAR_SLICE_MB * 1024U * 1024U));
+
+    if (engine->tt == NULL) {
+        return;
+    }
+    if (thread_count > max_by_size) {
+        thread_count = max_by_size;
+    }
+    if (thread_count > SEARCH_MAX_THREADS) {
+        thread_count = SEARCH_MAX_THREADS;
+    }
+    if (thread_count <= 1) {
+        memset(engine->tt, 0, total);
+        return;
+    }
+
+    buckets_per_slice = (size_t)((engine->tt_bucket_mask + 1ULL) / (uint64_t)thread_count);
+    for (int i = 0; i < thread_count; ++i) {
+        size_t first = (size_t)i * buckets_per_slice;
+        size_t count = (i == thread_count - 1) ? (size_t)(engine->tt_bucket_mask + 1ULL) - first : buckets_per_slice;
+
+        slices[i].start = &engine->tt[first];
+        slices[i].bytes = count * sizeof(TTBucket);
+    }
+
+    for (int i = 1; i < thread_count; ++i) {
+        futures[i] = chess_pool_submit(pool, tt_clear_slice, &slices[i]);
+        if (futures[i] == NULL) {
+            tt_clear_slice(&slices[i]);
+        }
+    }
+    tt_clear_slice(&slices[0]);
+    for (int i = 1; i < thread_count; ++i) {
+        (void)chess_future_wait(futures[i]);
+    }
+}
+
+/*
+ * (Re)allocates the table as the largest power-of-two bucket count that fits size_mb.
+ * On Linux the block is mmap'd and marked MADV_HUGEPAGE so the table is backed by
+ * transparent huge pages (far fewer TLB misses); elsewhere, or if mmap fails, it
+ * falls back to a cache-line aligned malloc.
+ */
+static bool tt_allocate(Engine* engine, int size_mb) {
+    uint64_t bytes = (uint64_t)size_mb * 1024ULL * 1024ULL;
+    uint64_t buckets = 1ULL;
+    size_t table_bytes;
+    void* block = NULL;
+    size_t block_bytes = 0U;
+    bool mapped = false;
+    bool huge_pages = false;
+
+    while (buckets * 2ULL * sizeof(TTBucket) <= bytes) {
+        buckets *= 2ULL;
+    }
+    if (buckets * sizeof(TTBucket) > (uint64_t)(SIZE_MAX - TT_HUGE_PAGE_BYTES)) {
+        return false;
+    }
+    table_bytes = (size_t)(buckets * sizeof(TTBucket));
+
+#ifdef CHESS_TT_USE_MMAP
+    block_bytes = (table_bytes + (TT_HUGE_PAGE_BYTES - 1U)) & ~(size_t)(TT_HUGE_PAGE_BYTES - 1U);
+    block = mmap(NULL, block_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (block == MAP_FAILED) {
+        block = NULL;
+    } else {
+        mapped = true;
+#ifdef MADV_HUGEPAGE
+        huge_pages = (madvise(block, block_bytes, MADV_HUGEPAGE) == 0);
+#endif
+    }
+#endif
+
+    if (block == NULL) {
+        block_bytes = table_bytes + TT_BUCKET_BYTES;
+        block = malloc(block_bytes);
+        if (block == NULL) {
+            return false;
+        }
+    }
+
+    tt_release(engine);
+    engine->tt_block = block;
+    engine->tt_block_bytes = block_bytes;
+    engine->tt_mapped = mapped;
+    engine->tt_huge_pages = huge_pages;
+    engine->tt = (TTBucket*)(((uintptr_t)block + (TT_BUCKET_BYTES - 1)) & ~(uintptr_t)(TT_BUCKET_BYTES - 1));
+    engine->tt_bucket_mask = buckets - 1ULL;
+    engine->tt_size_mb = size_mb;
+    tt_clear(engine);
+    return true;
+}
+
+/* Allocates the default table on first use, halving the size if memory is short. */
+static bool tt_ensure(Engine* engine) {
+    int size_mb = engine->tt_size_mb;
+
+    while (engine->tt == NULL && size_mb >= 1) {
+        if (tt_allocate(engine, size_mb)) {
+            return true;
+        }
+        size_mb /= 2;
+    }
+    return engine->tt != NULL;
+}
+
+static uint64_t tt_pack(int score, PackedMove move, int depth, uint8_t gen_flag) {
+    return (uint64_t)(uint32_t)score |
+           ((uint64_t)move << 32) |
+           ((uint64_t)(uint8_t)(int8_t)depth << 48) |
+           ((uint64_t)gen_flag << 56);
+}
+
+static void tt_unpack(uint64_t data, TTData* out) {
+    out->score = (int32_t)(uint32_t)data;
+    out->best_move = (PackedMove)(data >> 32);
+    out->depth = (int8_t)(uint8_t)(data >> 48);
+    out->gen_flag = (uint8_t)(data >> 56);
+}
+
+/* Issues a cache prefetch for the bucket of key (used right after make-move). */
+static void tt_prefetch(const Engine* engine, uint64_t key) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(&engine->tt[key & engine->tt_bucket_mask]);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch((const char*)&engine->tt[key & engine->tt_bucket_mask], _MM_HINT_T0);
+#else
+    (void)engine;
+    (void)key;
+#endif
+}
+
+/* Lock-free probe: a slot hits only when its stored key_xor ^ data equals key. */
+static bool tt_probe(const Engine* engine, uint64_t key, TTData* out) {
+    TTBucket* bucket = &engine->tt[key & engine->tt_bucket_mask];
+
+    for (int i = 0; i < TT_BUCKET_SLOTS; ++i) {
+        uint64_t data = atomic_load_explicit(&bucket->entries[i].data, memory_order_relaxed);
+        uint64_t key_xor = atomic_load_explicit(&bucket->entries[i].key_xor, memory_order_relaxed);
+
+        if (data != 0ULL && (key_xor ^ data) == key) {
+            tt_unpack(data, out);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Stores one result. A same-key slot is refreshed unless it holds a deeper
+ * result from this search; otherwise the slot with the lowest
+ * depth - 8 * age is evicted (empty slots first).
+ */
+static void tt_store(Engine* engine, uint64_t key, int depth, int score, PackedMove move, uint8_t flag, uint8_t generation) {
+    TTBucket* bucket = &engine->tt[key & engine->tt_bucket_mask];
+    TTEntry* replace = &bucket->entries[0];
+    int replace_worth = INT_MAX;
+    uint64_t data;
+
+    for (int i = 0; i < TT_BUCKET_SLOTS; ++i) {
+        TTEntry* slot = &bucket->entries[i];
+        uint64_t slot_data = atomic_load_explicit(&slot->data, memory_order_relaxed);
+        uint64_t slot_key_xor = atomic_load_explicit(&slot->key_xor, memory_order_relaxed);
+        TTData old;
+        int worth;
+
+        if (slot_data == 0ULL) {
+            if (replace_worth > INT_MIN) {
+                replace = slot;
+                replace_worth = INT_MIN;
+            }
+            continue;
+        }
+
+        tt_unpack(slot_data, &old);
+        if ((slot_key_xor ^ slot_data) == key) {
+            if (depth + (flag == TT_FLAG_EXACT ? 1 : 0) < old.depth &&
+                TT_ENTRY_GENERATION(&old) == generation) {
+                return;
+            }
+            if (move == PACKED_MOVE_NONE) {
+                move = old.best_move;
+            }
+            replace = slot;
+            break;
+        }
+
+        worth = old.depth - 8 * (int)((generation - TT_ENTRY_GENERATION(&old)) & TT_GENERATION_MASK);
+        if (worth < replace_worth) {
+            replace = slot;
+            replace_worth = worth;
+        }
+    }
+
+    data = tt_pack(score, move, depth, TT_GEN_FLAG(generation, flag));
+    atomic_store_explicit(&replace->data, data, memory_order_relaxed);
+    atomic_store_explicit(&replace->key_xor, key ^ data, memory_order_relaxed);
+}
+
 /* Light repetition detection over current PV path (draw by repetition). */
 static bool is_repetition(const SearchContext* ctx, uint64_t key) {
     for (int i = ctx->path_len - 2; i >= 0; i -= 2) {
@@ -636,13 +950,29 @@ static bool search_should_stop(SearchContext* ctx) {
     if (ctx->stop) {
         return true;
     }
-    if (ctx->limits.max_time_ms <= 0) {
+    if (ctx->shared_stop != NULL && atomic_load_explicit(ctx->shared_stop, memory_order_relaxed)) {
+        ctx->stop = true;
+        return true;
+    }
+    if (ctx->abort_flag != NULL && atomic_load_explicit(ctx->abort_flag, memory_order_relaxed)) {
+        ctx->stop = true;
+        return true;
+    }
+    /* Exact (not polled) so node-limited searches are reproducible; helpers follow via shared_stop. */
+    if (ctx->thread_id == 0 && ctx->limits.max_nodes > 0ULL && ctx->nodes >= ctx->limits.max_nodes) {
+        ctx->stop = true;
+        return true;
+    }
+    if (ctx->time.hard_ms <= 0) {
         return false;
     }
     if ((ctx->nodes & 1023ULL) != 0ULL) {
         return false;
     }
-    if ((now_ms() - ctx->start_ms) >= (uint64_t)ctx->limits.max_time_ms) {
+    if (ctx->ponder_flag != NULL && atomic_load_explicit(ctx->ponder_flag, memory_order_relaxed)) {
+        return false;
+    }
+    if (time_manager_expired(&ctx->time)) {
         ctx->stop = true;
         return true;
     }
@@ -650,41 +980,36 @@ static bool search_should_stop(SearchContext* ctx) {
 }
 
 /* Static exchange-inspired capture bonus used in move ordering. */
-static int score_capture(const Position* pos, Move move) {
-    Side us;
-    Side them;
-    Side side;
-    PieceType piece;
+static int score_capture(const Position* pos, PackedMove move) {
+    uint8_t victim;
+    uint8_t attacker;
     int captured_value = g_capture_values[PIECE_PAWN];
     int attacker_value = g_capture_values[PIECE_PAWN];
 
-    if ((move.flags & MOVE_FLAG_CAPTURE) == 0U) {
+    if (!PACKED_IS_CAPTURE(move)) {
         return 0;
     }
 
-    us = pos->side_to_move;
-    them = (us == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
-
-    if ((move.flags & MOVE_FLAG_EN_PASSANT) != 0U) {
-        captured_value = g_capture_values[PIECE_PAWN];
-    } else if (position_piece_at(pos, move.to, &side, &piece) && side == them) {
-        captured_value = g_capture_values[piece];
+    /* Legal captures always find the victim on `to` (except en passant) and our piece on `from`. */
+    victim = pos->board[PACKED_TO(move)];
+    attacker = pos->board[PACKED_FROM(move)];
+    if (PACKED_KIND(move) != MOVE_KIND_EN_PASSANT && victim != MAILBOX_EMPTY) {
+        captured_value = g_capture_values[victim & 7U];
     }
-
-    if (position_piece_at(pos, move.from, &side, &piece) && side == us) {
-        attacker_value = g_capture_values[piece];
+    if (attacker != MAILBOX_EMPTY) {
+        attacker_value = g_capture_values[attacker & 7U];
     }
 
     return (captured_value * 16) - attacker_value;
 }
 
 /* Scores one move for ordering with TT move, MVV/LVA, killers and history. */
-static int score_move(const Position* pos, Move move, Move tt_move, const SearchContext* ctx, int ply, bool qsearch) {
+static int score_move(const Position* pos, PackedMove move, PackedMove tt_move, const SearchContext* ctx, int ply) {
     int score = 0;
-    bool is_capture = (move.flags & MOVE_FLAG_CAPTURE) != 0U;
-    bool is_promo = (move.flags & MOVE_FLAG_PROMOTION) != 0U;
+    bool is_capture = PACKED_IS_CAPTURE(move);
+    bool is_promo = PACKED_IS_PROMOTION(move);
 
-    if (move_same(move, tt_move)) {
+    if (move == tt_move) {
         score += 30000;
     }
 
@@ -693,55 +1018,323 @@ static int score_move(const Position* pos, Move move, Move tt_move, const Search
     }
 
     if (is_promo) {
-        score += 9000 + g_capture_values[move.promotion == PIECE_NONE ? PIECE_QUEEN : move.promotion];
+        score += 9000 + g_capture_values[PACKED_PROMOTION_PIECE(move)];
     }
 
-    if (!qsearch && (move.flags & (MOVE_FLAG_KING_CASTLE | MOVE_FLAG_QUEEN_CASTLE)) != 0U) {
+    if (PACKED_IS_CASTLE(move)) {
         score += 2200;
     }
 
-    if (!qsearch && !is_capture && !is_promo && ply >= 0 && ply < MAX_SEARCH_PLY) {
-        if (move_same(move, ctx->killer_moves[ply][0])) {
+    if (!is_capture && !is_promo && ply >= 0 && ply < MAX_SEARCH_PLY) {
+        if (move == ctx->killer_moves[ply][0]) {
             score += 7000;
-        } else if (move_same(move, ctx->killer_moves[ply][1])) {
+        } else if (move == ctx->killer_moves[ply][1]) {
             score += 6500;
         }
 
-        score += ctx->history[pos->side_to_move][move.from][move.to];
+        score += ctx->history[pos->side_to_move][PACKED_FROM(move)][PACKED_TO(move)];
     }
 
     return score;
 }
 
-/* Orders moves by score in descending order (insertion sort fits small lists). */
+/* Fully orders the root move list (insertion sort fits small lists); scores is scratch space. */
 static void sort_moves(const Position* pos,
-                       MoveList* list,
-                       Move tt_move,
+                       PackedMoveList* list,
+                       int scores[MAX_MOVES],
+                       PackedMove tt_move,
                        const SearchContext* ctx,
-                       int ply,
-                       bool qsearch) {
+                       int ply) {
     for (int i = 0; i < list->count; ++i) {
-        int s = score_move(pos, list->moves[i], tt_move, ctx, ply, qsearch);
-        list->moves[i].score = (int16_t)((s > 32767) ? 32767 : ((s < -32768) ? -32768 : s));
+        scores[i] = score_move(pos, list->moves[i], tt_move, ctx, ply);
     }
 
     for (int i = 1; i < list->count; ++i) {
-        Move key = list->moves[i];
+        PackedMove key = list->moves[i];
+        int key_score = scores[i];
         int j = i - 1;
 
-        while (j >= 0 && list->moves[j].score < key.score) {
+        while (j >= 0 && scores[j] < key_score) {
             list->moves[j + 1] = list->moves[j];
+            scores[j + 1] = scores[j];
             j--;
         }
 
         list->moves[j + 1] = key;
+        scores[j + 1] = key_score;
+    }
+}
+
+/* Stages of the lazy move picker, in the order they are visited. */
+typedef enum PickStage {
+    PICK_STAGE_TT = 0,
+    PICK_STAGE_GENERATE,
+    PICK_STAGE_GOOD_CAPTURES,
+    PICK_STAGE_KILLERS,
+    PICK_STAGE_QUIETS_INIT,
+    PICK_STAGE_QUIETS,
+    PICK_STAGE_BAD_CAPTURES,
+    PICK_STAGE_QSEARCH_QUIETS,
+    PICK_STAGE_DONE
+} PickStage;
+
+/*
+ * Lazy staged move picker. The TT move is tried before any generation, and
+ * each later stage is only scored when reached; moves are taken with a
+ * select-best scan so a cutoff never pays for sorting the rest of the list.
+ * moves[0, capture_end) holds captures and promotions, the remainder quiets.
+ * Quiescence pickers generate only captures unless they are in check (evasions)
+ * or still allowed quiet checks; `complete` says whether every legal move was generated.
+ * Out of check, quiescence drops SEE-losing captures (`skip_bad_captures`) entirely.
+ */
+typedef struct MovePicker {
+    const Position* pos;
+    const SearchContext* ctx;
+    PackedMoveList moves;
+    int scores[MAX_MOVES];
+    PackedMove tt_move;
+    PackedMove killers[2];
+    int ply;
+    int stage;
+    int index;
+    int capture_end;
+    int bad_start;
+    int killer_index;
+    bool in_check;
+    bool qsearch;
+    bool qsearch_quiets;
+    bool skip_bad_captures;
+    bool complete;
+} MovePicker;
+
+/* Bias that keeps winning/equal captures above every losing one. */
+#define PICK_GOOD_CAPTURE_BONUS (1 << 20)
+
+/*
+ * Scores one capture/promotion by MVV/LVA. A capture is "bad" when static exchange evaluation
+ * says it loses material; taking an equal or bigger piece can never lose, so SEE is skipped there.
+ */
+static int score_tactical(const Position* pos, PackedMove move) {
+    int score = 0;
+    bool good = true;
+
+    if (PACKED_IS_CAPTURE(move)) {
+        uint8_t victim = pos->board[PACKED_TO(move)];
+        uint8_t attacker = pos->board[PACKED_FROM(move)];
+
+        score = 10000 + score_capture(pos, move);
+        if (PACKED_KIND(move) != MOVE_KIND_EN_PASSANT && victim != MAILBOX_EMPTY && attacker != MAILBOX_EMPTY &&
+            g_capture_values[victim & 7U] < g_capture_values[attacker & 7U] &&
+            engine_see_packed(pos, move) < 0) {
+            good = false;
+        }
+    }
+
+    if (PACKED_IS_PROMOTION(move)) {
+        PieceType promo = PACKED_PROMOTION_PIECE(move);
+
+        score += 9000 + g_capture_values[promo];
+        good = (promo == PIECE_QUEEN);
+    }
+
+    return good ? (score + PICK_GOOD_CAPTURE_BONUS) : score;
+}
+
+/* Swaps the highest-scored move of [picker->index, end) into place and returns its slot. */
+static int picker_select_best(MovePicker* picker, int end) {
+    int best = picker->index;
+
+    for (int i = picker->index + 1; i < end; ++i) {
+        if (picker->scores[i] > picker->scores[best]) {
+            best = i;
+        }
+    }
+
+    if (best != picker->index) {
+        PackedMove tmp_move = picker->moves.moves[best];
+        int tmp_score = picker->scores[best];
+
+        picker->moves.moves[best] = picker->moves.moves[picker->index];
+        picker->scores[best] = picker->scores[picker->index];
+        picker->moves.moves[picker->index] = tmp_move;
+        picker->scores[picker->index] = tmp_score;
+    }
+
+    return picker->index++;
+}
+
+/* Prepares a picker; quiescence pickers skip killers/history and only yield quiets on request. */
+static void picker_init(MovePicker* picker,
+                        const Position* pos,
+                        const SearchContext* ctx,
+                        PackedMove tt_move,
+                        int ply,
+                        bool in_check,
+                        bool qsearch,
+                        bool qsearch_quiets) {
+    picker->pos = pos;
+    picker->ctx = ctx;
+    picker->moves.count = 0;
+    picker->tt_move = tt_move;
+    picker->ply = ply;
+    picker->stage = (tt_move != PACKED_MOVE_NONE) ? PICK_STAGE_TT : PICK_STAGE_GENERATE;
+    picker->index = 0;
+    picker->capture_end = 0;
+    picker->bad_start = 0;
+    picker->killer_index = 0;
+    picker->in_check = in_check;
+    picker->qsearch = qsearch;
+    picker->qsearch_quiets = qsearch_quiets || in_check;
+    picker->skip_bad_captures = qsearch && !in_check;
+    picker->complete = false;
+    picker->killers[0] = PACKED_MOVE_NONE;
+    picker->killers[1] = PACKED_MOVE_NONE;
+    if (!qsearch && ply >= 0 && ply < MAX_SEARCH_PLY) {
+        picker->killers[0] = ctx->killer_moves[ply][0];
+        picker->killers[1] = ctx->killer_moves[ply][1];
+    }
+}
+
+/* Produces the next legal move in staged order; returns false once exhausted. */
+static bool picker_next(MovePicker* picker, PackedMove* out_move) {
+    while (true) {
+        switch (picker->stage) {
+            case PICK_STAGE_TT:
+                picker->stage = PICK_STAGE_GENERATE;
+                if (engine_packed_is_legal(picker->pos, picker->tt_move)) {
+                    *out_move = picker->tt_move;
+                    return true;
+                }
+                picker->tt_move = PACKED_MOVE_NONE;
+                break;
+
+            case PICK_STAGE_GENERATE: {
+                PackedMoveList* list = &picker->moves;
+                int i = 0;
+
+                if (picker->in_check) {
+                    engine_generate_evasions_packed(picker->pos, list);
+                } else if (picker->qsearch && !picker->qsearch_quiets) {
+                    engine_generate_captures_packed(picker->pos, list);
+                } else {
+                    engine_generate_legal_packed(picker->pos, list);
+                }
+                picker->complete = !picker->qsearch || picker->qsearch_quiets;
+
+                /* Tactical moves are packed to the front and scored now; quiets wait for their stage. */
+                while (i < list->count) {
+                    PackedMove move = list->moves[i];
+
+                    if (move == picker->tt_move) {
+                        list->moves[i] = list->moves[--list->count];
+                        continue;
+                    }
+                    if (PACKED_IS_TACTICAL(move)) {
+                        list->moves[i] = list->moves[picker->capture_end];
+                        list->moves[picker->capture_end] = move;
+                        picker->scores[picker->capture_end] = score_tactical(picker->pos, move);
+                        picker->capture_end++;
+                    }
+                    i++;
+                }
+                picker->stage = PICK_STAGE_GOOD_CAPTURES;
+                break;
+            }
+
+            case PICK_STAGE_GOOD_CAPTURES:
+                if (picker->index < picker->capture_end) {
+                    int slot = picker_select_best(picker, picker->capture_end);
+
+                    if (picker->scores[slot] >= PICK_GOOD_CAPTURE_BONUS) {
+                        *out_move = picker->moves.moves[slot];
+                        return true;
+                    }
+                    picker->index--;
+                }
+                picker->bad_start = picker->index;
+                if (picker->skip_bad_captures) {
+                    picker->index = picker->capture_end;
+                    picker->stage = picker->qsearch_quiets ? PICK_STAGE_QSEARCH_QUIETS : PICK_STAGE_DONE;
+                } else if (picker->qsearch) {
+                    picker->stage = PICK_STAGE_BAD_CAPTURES;
+                } else {
+                    picker->index = picker->capture_end;
+                    picker->stage = PICK_STAGE_KILLERS;
+                }
+                break;
+
+            case PICK_STAGE_KILLERS:
+                while (picker->killer_index < 2) {
+                    PackedMove killer = picker->killers[picker->killer_index++];
+
+                    if (killer == PACKED_MOVE_NONE || PACKED_IS_TACTICAL(killer) || killer == picker->tt_move) {
+                        continue;
+                    }
+                    for (int i = picker->index; i < picker->moves.count; ++i) {
+                        if (picker->moves.moves[i] == killer) {
+                            picker->moves.moves[i] = picker->moves.moves[picker->index];
+                            picker->moves.moves[picker->index] = killer;
+                            *out_move = picker->moves.moves[picker->index++];
+                            return true;
+                        }
+                    }
+                }
+                picker->stage = PICK_STAGE_QUIETS_INIT;
+                break;
+
+            case PICK_STAGE_QUIETS_INIT: {
+                Side us = picker->pos->side_to_move;
+
+                for (int i = picker->index; i < picker->moves.count; ++i) {
+                    PackedMove move = picker->moves.moves[i];
+                    int score = picker->ctx->history[us][PACKED_FROM(move)][PACKED_TO(move)];
+
+                    if (PACKED_IS_CASTLE(move)) {
+                        score += 2200;
+                    }
+                    picker->scores[i] = score;
+                }
+                picker->stage = PICK_STAGE_QUIETS;
+                break;
+            }
+
+            case PICK_STAGE_QUIETS:
+                if (picker->index < picker->moves.count) {
+                    *out_move = picker->moves.moves[picker_select_best(picker, picker->moves.count)];
+                    return true;
+                }
+                picker->index = picker->bad_start;
+                picker->stage = PICK_STAGE_BAD_CAPTURES;
+                break;
+
+            case PICK_STAGE_BAD_CAPTURES:
+                if (picker->index < picker->capture_end) {
+                    *out_move = picker->moves.moves[picker_select_best(picker, picker->capture_end)];
+                    return true;
+                }
+                picker->stage = (picker->qsearch && picker->qsearch_quiets) ? PICK_STAGE_QSEARCH_QUIETS : PICK_STAGE_DONE;
+                picker->index = picker->capture_end;
+                break;
+
+            case PICK_STAGE_QSEARCH_QUIETS:
+                /* Quiescence quiets (evasions, checks) keep generation order; no history is kept there. */
+                if (picker->index < picker->moves.count) {
+                    *out_move = picker->moves.moves[picker->index++];
+                    return true;
+                }
+                picker->stage = PICK_STAGE_DONE;
+                break;
+
+            default:
+                return false;
+        }
     }
 }
 
 /* Looks up previous-iteration root score for one move (or -INF when unknown). */
-static int root_score_for_move(const MoveList* root_moves, const int root_scores[MAX_MOVES], Move move) {
+static int root_score_for_move(const PackedMoveList* root_moves, const int root_scores[MAX_MOVES], PackedMove move) {
     for (int i = 0; i < root_moves->count; ++i) {
-        if (move_same(root_moves->moves[i], move)) {
+        if (root_moves->moves[i] == move) {
             return root_scores[i];
         }
     }
@@ -749,11 +1342,11 @@ static int root_score_for_move(const MoveList* root_moves, const int root_scores
 }
 
 /* Reorders already-scored root moves using previous-depth scores first. */
-static void sort_root_moves_by_previous_scores(MoveList* depth_moves,
-                                               const MoveList* root_moves,
+static void sort_root_moves_by_previous_scores(PackedMoveList* depth_moves,
+                                               const PackedMoveList* root_moves,
                                                const int root_scores[MAX_MOVES]) {
     for (int i = 1; i < depth_moves->count; ++i) {
-        Move key = depth_moves->moves[i];
+        PackedMove key = depth_moves->moves[i];
         int key_prev = root_score_for_move(root_moves, root_scores, key);
         int j = i - 1;
 
@@ -770,6 +1363,18 @@ static void sort_root_moves_by_previous_scores(MoveList* depth_moves,
     }
 }
 
+/* Rotates root moves after the first by thread_id places to diversify Lazy SMP helper ordering. */
+static void rotate_root_tail(PackedMoveList* moves, int thread_id) {
+    PackedMove rotated[MAX_MOVES];
+    int tail = moves->count - 1;
+    int shift = thread_id % tail;
+
+    for (int i = 0; i < tail; ++i) {
+        rotated[i] = moves->moves[1 + ((i + shift) % tail)];
+    }
+    memcpy(&moves->moves[1], rotated, (size_t)tail * sizeof(PackedMove));
+}
+
 /* True when king already reached classical castled squares. */
 static bool side_is_castled(const Position* pos, Side side) {
     Bitboard king = pos->pieces[side][PIECE_KING];
@@ -859,52 +1464,137 @@ static int pawn_structure_score(const Position* pos, Side side) {
     return score;
 }
 
-/* Piece activity and rook file-quality evaluation for one side. */
-static int mobility_score(const Position* pos, Side side) {
-    Side them = (side == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
-    Bitboard own = pos->occupied[side];
-    int score = 0;
-    Bitboard bb;
+/* Fills one pawn-hash entry for the position's pawn structure. */
+static void pawn_entry_compute(const Position* pos, PawnHashEntry* entry) {
+    entry->key = pos->pawn_key;
 
-    bb = pos->pieces[side][PIECE_KNIGHT];
-    while (bb != 0ULL) {
-        int sq = pop_lsb(&bb);
-        score += bit_count(engine_get_knight_attacks(sq) & ~own) * 4;
+    for (int side = SIDE_WHITE; side <= SIDE_BLACK; ++side) {
+        Bitboard pawns = pos->pieces[side][PIECE_PAWN];
+        uint8_t files = 0U;
+
+        entry->score[side] = (int16_t)pawn_structure_score(pos, (Side)side);
+        while (pawns != 0ULL) {
+            files |= (uint8_t)(1U << (pop_lsb(&pawns) & 7));
+        }
+        entry->pawn_files[side] = files;
     }
+}
 
-    bb = pos->pieces[side][PIECE_BISHOP];
-    while (bb != 0ULL) {
-        int sq = pop_lsb(&bb);
-        score += bit_count(engine_get_bishop_attacks(sq, pos->all_occupied) & ~own) * 4;
+/* Returns cached pawn terms from the thread's pawn hash (scratch is used without a context). */
+static const PawnHashEntry* pawn_probe(SearchContext* ctx, const Position* pos, PawnHashEntry* scratch) {
+    PawnHashEntry* entry;
+
+    if (ctx == NULL) {
+        pawn_entry_compute(pos, scratch);
+        return scratch;
     }
 
-    bb = pos->pieces[side][PIECE_ROOK];
-    while (bb != 0ULL) {
-        int sq = pop_lsb(&bb);
-        Bitboard mask = file_mask(sq & 7);
+    entry = &ctx->pawn_table[pos->pawn_key & (PAWN_HASH_ENTRIES - 1)];
+    ctx->pawn_probes++;
+    if (entry->key == pos->pawn_key) {
+        ctx->pawn_hits++;
+        return entry;
+    }
+
+    pawn_entry_compute(pos, entry);
+    return entry;
+}
+
+/*
+ * Attack map of one evaluated position, built once and read by every eval term:
+ * per-piece-type attack unions, all attacks per side, enemy pieces hitting each
+ * king zone, and per-type mobility (attacked squares not holding own pieces).
+ */
+typedef struct AttackInfo {
+    Bitboard by_piece[2][6];
+    Bitboard all[2];
+    int king_square[2];
+    int king_zone_attackers[2];
+    int mobility[2][6];
+} AttackInfo;
+
+/* Generates each piece's attack set exactly once and folds it into the map. */
+static void attack_info_compute(const Position* pos, AttackInfo* info) {
+    Bitboard zone[2];
+
+    for (int side = SIDE_WHITE; side <= SIDE_BLACK; ++side) {
+        int king_sq = engine_find_king_square(pos, (Side)side);
+
+        info->king_square[side] = king_sq;
+        zone[side] = (king_sq >= 0) ? (engine_get_king_attacks(king_sq) | bb_square(king_sq)) : 0ULL;
+    }
+
+    for (int side = SIDE_WHITE; side <= SIDE_BLACK; ++side) {
+        Side them = (side == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
+        Bitboard own = pos->occupied[side];
+        int zone_hits = 0;
 
-        score += bit_count(engine_get_rook_attacks(sq, pos->all_occupied) & ~own) * 2;
+        info->all[side] = 0ULL;
+        for (int piece = PIECE_PAWN; piece <= PIECE_KING; ++piece) {
+            Bitboard bb = pos->pieces[side][piece];
+            Bitboard piece_attacks = 0ULL;
+            int mobility = 0;
+
+            while (bb != 0ULL) {
+                int sq = pop_lsb(&bb);
+                Bitboard attacks;
+
+                switch (piece) {
+                    case PIECE_PAWN: attacks = engine_get_pawn_attacks((Side)side, sq); break;
+                    case PIECE_KNIGHT: attacks = engine_get_knight_attacks(sq); break;
+                    case PIECE_BISHOP: attacks = engine_get_bishop_attacks(sq, pos->all_occupied); break;
+                    case PIECE_ROOK: attacks = engine_get_rook_attacks(sq, pos->all_occupied); break;
+                    case PIECE_QUEEN:
+                        attacks = engine_get_bishop_attacks(sq, pos->all_occupied) |
+                                  engine_get_rook_attacks(sq, pos->all_occupied);
+                        break;
+                    default: attacks = engine_get_king_attacks(sq); break;
+                }
 
-        if ((pos->pieces[side][PIECE_PAWN] & mask) == 0ULL) {
-            score += ((pos->pieces[them][PIECE_PAWN] & mask) == 0ULL) ? 18 : 9;
+                piece_attacks |= attacks;
+                if (piece != PIECE_PAWN && piece != PIECE_KING) {
+                    mobility += bit_count(attacks & ~own);
+                }
+                if (piece != PIECE_KING && (attacks & zone[them]) != 0ULL) {
+                    zone_hits++;
+                }
+            }
+
+            info->by_piece[side][piece] = piece_attacks;
+            info->mobility[side][piece] = mobility;
+            info->all[side] |= piece_attacks;
         }
+        info->king_zone_attackers[them] = zone_hits;
     }
+}
+
+/* Piece activity and rook file-quality evaluation for one side. */
+static int mobility_score(const Position* pos, Side side, const PawnHashEntry* pawns, const AttackInfo* attacks) {
+    Side them = (side == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
+    int score = attacks->mobility[side][PIECE_KNIGHT] * 4 +
+                attacks->mobility[side][PIECE_BISHOP] * 4 +
+                attacks->mobility[side][PIECE_ROOK] * 2 +
+                attacks->mobility[side][PIECE_QUEEN];
+    Bitboard bb = pos->pieces[side][PIECE_ROOK];
 
-    bb = pos->pieces[side][PIECE_QUEEN];
     while (bb != 0ULL) {
-        int sq = pop_lsb(&bb);
-        Bitboard attacks = engine_get_bishop_attacks(sq, pos->all_occupied) |
-                           engine_get_rook_attacks(sq, pos->all_occupied);
-        score += bit_count(attacks & ~own);
+        uint8_t file_bit = (uint8_t)(1U << (pop_lsb(&bb) & 7));
+
+        if ((pawns->pawn_files[side] & file_bit) == 0U) {
+            score += ((pawns->pawn_files[them] & file_bit) == 0U) ? 18 : 9;
+        }
     }
 
     return score;
 }
 
 /* King safety and castling incentives for one side. */
-static int king_safety_score(const Position* pos, Side side, int phase) {
-    Side them = (side == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
-    int king_sq = engine_find_king_square(pos, side);
+static int king_safety_score(const Position* pos,
+                             Side side,
+                             int phase,
+                             const PawnHashEntry* pawns_info,
+                             const AttackInfo* attacks) {
+    int king_sq = attacks->king_square[side];
     int score = 0;
 
     if (king_sq < 0) {
@@ -951,80 +1641,29 @@ static int king_safety_score(const Position* pos, Side side, int phase) {
             } else {
                 score -= 9;
             }
-        }
-    }
-
-    {
-        Bitboard zone = engine_get_king_attacks(king_sq) | bb_square(king_sq);
-        int attackers = 0;
-        Bitboard bb_attackers;
-
-        bb_attackers = pos->pieces[them][PIECE_PAWN];
-        while (bb_attackers != 0ULL) {
-            int sq = pop_lsb(&bb_attackers);
-            if ((engine_get_pawn_attacks(them, sq) & zone) != 0ULL) {
-                attackers++;
-            }
-        }
-
-        bb_attackers = pos->pieces[them][PIECE_KNIGHT];
-        while (bb_attackers != 0ULL) {
-            int sq = pop_lsb(&bb_attackers);
-            if ((engine_get_knight_attacks(sq) & zone) != 0ULL) {
-                attackers++;
+            /* With heavy pieces around, a file next to the king with no own pawn is an open line. */
+            if (phase >= 10 && (pawns_info->pawn_files[side] & (1U << f)) == 0U) {
+                score -= 8;
             }
         }
-
-        bb_attackers = pos->pieces[them][PIECE_BISHOP];
-        while (bb_attackers != 0ULL) {
-            int sq = pop_lsb(&bb_attackers);
-            if ((engine_get_bishop_attacks(sq, pos->all_occupied) & zone) != 0ULL) {
-                attackers++;
-            }
-        }
-
-        bb_attackers = pos->pieces[them][PIECE_ROOK];
-        while (bb_attackers != 0ULL) {
-            int sq = pop_lsb(&bb_attackers);
-            if ((engine_get_rook_attacks(sq, pos->all_occupied) & zone) != 0ULL) {
-                attackers++;
-            }
-        }
-
-        bb_attackers = pos->pieces[them][PIECE_QUEEN];
-        while (bb_attackers != 0ULL) {
-            int sq = pop_lsb(&bb_attackers);
-            Bitboard attacks = engine_get_bishop_attacks(sq, pos->all_occupied) |
-                               engine_get_rook_attacks(sq, pos->all_occupied);
-            if ((attacks & zone) != 0ULL) {
-                attackers++;
-            }
-        }
-
-        score -= attackers * ((phase >= 14) ? 11 : 6);
     }
 
+    score -= attacks->king_zone_attackers[side] * ((phase >= 14) ? 11 : 6);
     return score;
 }
 
 /* Penalizes tactically loose pieces (attacked and weakly defended). */
-static int piece_safety_score(const Position* pos, Side side) {
+static int piece_safety_score(const Position* pos, Side side, const AttackInfo* attacks) {
     Side them = (side == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
     int score = 0;
 
     for (int piece = PIECE_PAWN; piece <= PIECE_QUEEN; ++piece) {
-        Bitboard bb = pos->pieces[side][piece];
+        Bitboard bb = pos->pieces[side][piece] & attacks->all[them];
 
         while (bb != 0ULL) {
             int sq = pop_lsb(&bb);
-            bool attacked = engine_is_square_attacked(pos, sq, them);
-            bool defended = engine_is_square_attacked(pos, sq, side);
 
-            if (!attacked) {
-                continue;
-            }
-
-            if (!defended) {
+            if ((attacks->all[side] & bb_square(sq)) == 0ULL) {
                 score -= g_capture_values[piece] / 5;
             } else {
                 score -= g_capture_values[piece] / 10;
@@ -1102,46 +1741,29 @@ static int opening_development_score(const Position* pos, Side side, int phase)
     return score;
 }
 
-/* Blend MG/EG PST-evaluation and convert to side-to-move perspective. */
-static int evaluate_for_side(const Position* pos) {
-    int mg = 0;
-    int eg = 0;
-    int phase = 0;
-
-    for (int side = SIDE_WHITE; side <= SIDE_BLACK; ++side) {
-        for (int piece = PIECE_PAWN; piece <= PIECE_QUEEN; ++piece) {
-            phase += g_phase_weights[piece] * bit_count(pos->pieces[side][piece]);
-        }
-    }
-
-    if (phase > 24) {
-        phase = 24;
-    }
+/* Blend MG/EG PST-evaluation and convert to side-to-move perspective (ctx may be NULL). */
+static int evaluate_for_side(const Position* pos, SearchContext* ctx) {
+    PawnHashEntry pawn_scratch;
+    const PawnHashEntry* pawns = pawn_probe(ctx, pos, &pawn_scratch);
+    AttackInfo attacks;
+    int mg = pos->psq_mg;
+    int eg = pos->psq_eg;
+    int phase = (pos->phase > 24) ? 24 : pos->phase;
 
+    attack_info_compute(pos, &attacks);
     for (int side = SIDE_WHITE; side <= SIDE_BLACK; ++side) {
         int sign = (side == SIDE_WHITE) ? 1 : -1;
 
-        for (int piece = PIECE_PAWN; piece <= PIECE_KING; ++piece) {
-            Bitboard bb = pos->pieces[side][piece];
-
-            while (bb != 0ULL) {
-                int sq = pop_lsb(&bb);
-                int pst_sq = (side == SIDE_WHITE) ? sq : mirror_square(sq);
-                mg += sign * (g_eval_values[piece] + g_pst_mg[piece][pst_sq]);
-                eg += sign * (g_eval_values[piece] + g_pst_eg[piece][pst_sq]);
-            }
-        }
-
         if (bit_count(pos->pieces[side][PIECE_BISHOP]) >= 2) {
             mg += sign * 35;
             eg += sign * 45;
         }
 
         {
-            int pawn = pawn_structure_score(pos, (Side)side);
-            int mobility = mobility_score(pos, (Side)side);
-            int king = king_safety_score(pos, (Side)side, phase);
-            int safety = piece_safety_score(pos, (Side)side);
+            int pawn = pawns->score[side];
+            int mobility = mobility_score(pos, (Side)side, pawns, &attacks);
+            int king = king_safety_score(pos, (Side)side, phase, pawns, &attacks);
+            int safety = piece_safety_score(pos, (Side)side, &attacks);
             int development = opening_development_score(pos, (Side)side, phase);
 
             mg += sign * (pawn + mobility + king + safety + development);
@@ -1156,22 +1778,59 @@ static int evaluate_for_side(const Position* pos) {
     }
 }
 
+/*
+ * Side-to-move static eval through the shared direct-mapped cache. Each entry is
+ * a single atomic word (upper 48 key bits | eval), so concurrent threads can
+ * never observe a key paired with another position's score.
+ */
+static int evaluate_cached(const Position* pos, SearchContext* ctx) {
+    _Atomic uint64_t* slot = &ctx->engine->eval_cache[pos->zobrist_key & (EVAL_CACHE_ENTRIES - 1U)];
+    uint64_t entry = atomic_load_explicit(slot, memory_order_relaxed);
+    int eval;
+
+    ctx->eval_probes++;
+    if (entry != 0ULL && (entry & EVAL_CACHE_KEY_MASK) == (pos->zobrist_key & EVAL_CACHE_KEY_MASK)) {
+        ctx->eval_hits++;
+        return (int)(int16_t)(uint16_t)(entry & 0xFFFFULL);
+    }
+
+    eval = evaluate_for_side(pos, ctx);
+    if (eval >= INT16_MIN && eval <= INT16_MAX) {
+        atomic_store_explicit(slot,
+                              (pos->zobrist_key & EVAL_CACHE_KEY_MASK) | (uint64_t)(uint16_t)(int16_t)eval,
+                              memory_order_relaxed);
+    }
+    return eval;
+}
+
+/* Folds material into the PST tables, mirrored and signed per side, for Position's running totals. */
+void engine_init_psq_tables(void) {
+    for (int piece = PIECE_PAWN; piece <= PIECE_KING; ++piece) {
+        for (int sq = 0; sq < BOARD_SQUARES; ++sq) {
+            g_psq_mg[SIDE_WHITE][piece][sq] = g_eval_values[piece] + g_pst_mg[piece][sq];
+            g_psq_eg[SIDE_WHITE][piece][sq] = g_eval_values[piece] + g_pst_eg[piece][sq];
+            g_psq_mg[SIDE_BLACK][piece][sq] = -(g_eval_values[piece] + g_pst_mg[piece][mirror_square(sq)]);
+            g_psq_eg[SIDE_BLACK][piece][sq] = -(g_eval_values[piece] + g_pst_eg[piece][mirror_square(sq)]);
+        }
+    }
+}
+
 /* Public evaluation from White perspective. */
 int evaluate_position(const Position* pos) {
     Position white_pov = *pos;
     white_pov.side_to_move = SIDE_WHITE;
-    return evaluate_for_side(&white_pov);
+    return evaluate_for_side(&white_pov, NULL);
 }
 
 /* Lightweight killer/history update after quiet beta cutoff. */
 static void update_cutoff_heuristics(SearchContext* ctx,
                                      const Position* pos,
-                                     Move move,
-                                     const Move quiet_tried[64],
+                                     PackedMove move,
+                                     const PackedMove quiet_tried[64],
                                      int quiet_count,
                                      int depth,
                                      int ply) {
-    bool quiet = ((move.flags & MOVE_FLAG_CAPTURE) == 0U) && ((move.flags & MOVE_FLAG_PROMOTION) == 0U);
+    bool quiet = !PACKED_IS_TACTICAL(move);
     int bonus;
     int malus;
 
@@ -1179,7 +1838,7 @@ static void update_cutoff_heuristics(SearchContext* ctx,
         return;
     }
 
-    if (!move_same(move, ctx->killer_moves[ply][0])) {
+    if (move != ctx->killer_moves[ply][0]) {
         ctx->killer_moves[ply][1] = ctx->killer_moves[ply][0];
         ctx->killer_moves[ply][0] = move;
     }
@@ -1191,7 +1850,7 @@ static void update_cutoff_heuristics(SearchContext* ctx,
     malus = bonus / 2 + 1;
 
     {
-        int* hist = &ctx->history[pos->side_to_move][move.from][move.to];
+        int* hist = &ctx->history[pos->side_to_move][PACKED_FROM(move)][PACKED_TO(move)];
         *hist += bonus;
         if (*hist > 8000) {
             *hist = 8000;
@@ -1199,12 +1858,12 @@ static void update_cutoff_heuristics(SearchContext* ctx,
     }
 
     for (int i = 0; i < quiet_count; ++i) {
-        if (move_same(quiet_tried[i], move)) {
+        if (quiet_tried[i] == move) {
             continue;
         }
 
         {
-            int* hist = &ctx->history[pos->side_to_move][quiet_tried[i].from][quiet_tried[i].to];
+            int* hist = &ctx->history[pos->side_to_move][PACKED_FROM(quiet_tried[i])][PACKED_TO(quiet_tried[i])];
             *hist -= malus;
             if (*hist < -8000) {
                 *hist = -8000;
@@ -1213,22 +1872,24 @@ static void update_cutoff_heuristics(SearchContext* ctx,
     }
 }
 
-static int quiescence(const Position* pos, int alpha, int beta, int ply, int qdepth, SearchContext* ctx);
+static int quiescence(Position* pos, int alpha, int beta, int ply, int qdepth, SearchContext* ctx);
 
 /* Negamax with alpha-beta, TT, PVS, LMR, repetition and 50-move draw handling. */
-static int negamax(const Position* pos, int depth, int alpha, int beta, int ply, SearchContext* ctx) {
+static int negamax(Position* pos, int depth, int alpha, int beta, int ply, SearchContext* ctx) {
     int alpha_orig;
     int beta_orig;
     int result = 0;
     bool pushed = false;
-    TTEntry* entry;
-    Move tt_move = {0};
+    TTData tt_entry;
+    PackedMove tt_move = PACKED_MOVE_NONE;
     bool in_check;
     int static_eval = 0;
     int best_score = -INF_SCORE;
-    Move best_move = {0};
-    MoveList moves;
-    Move quiet_tried[64];
+    PackedMove best_move = PACKED_MOVE_NONE;
+    MovePicker picker;
+    PackedMove move;
+    int move_index = 0;
+    PackedMove quiet_tried[64];
     int quiet_count = 0;
 
     if (search_should_stop(ctx)) {
@@ -1261,7 +1922,7 @@ static int negamax(const Position* pos, int depth, int alpha, int beta, int ply,
     }
 
     if (ply >= MAX_SEARCH_PLY - 1) {
-        return evaluate_for_side(pos);
+        return evaluate_cached(pos, ctx);
     }
 
     ctx->nodes++;
@@ -1271,19 +1932,18 @@ static int negamax(const Position* pos, int depth, int alpha, int beta, int ply,
         pushed = true;
     }
 
-    entry = &g_tt[pos->zobrist_key & (TT_SIZE - 1)];
-    if (entry->key == pos->zobrist_key) {
-        int tt_score = score_from_tt(entry->score, ply);
-        tt_move = entry->best_move;
+    if (tt_probe(ctx->engine, pos->zobrist_key, &tt_entry)) {
+        int tt_score = score_from_tt(tt_entry.score, ply);
+        tt_move = tt_entry.best_move;
 
-        if (entry->depth >= depth) {
-            if (entry->flag == TT_FLAG_EXACT) {
+        if (tt_entry.depth >= depth) {
+            if (TT_ENTRY_FLAG(&tt_entry) == TT_FLAG_EXACT) {
                 result = tt_score;
                 goto cleanup;
             }
-            if (entry->flag == TT_FLAG_LOWER && tt_score > alpha) {
+            if (TT_ENTRY_FLAG(&tt_entry) == TT_FLAG_LOWER && tt_score > alpha) {
                 alpha = tt_score;
-            } else if (entry->flag == TT_FLAG_UPPER && tt_score < beta) {
+            } else if (TT_ENTRY_FLAG(&tt_entry) == TT_FLAG_UPPER && tt_score < beta) {
                 beta = tt_score;
             }
             if (alpha >= beta) {
@@ -1298,7 +1958,7 @@ static int negamax(const Position* pos, int depth, int alpha, int beta, int ply,
         depth++;
     }
 
-    static_eval = evaluate_for_side(pos);
+    static_eval = evaluate_cached(pos, ctx);
 
     if (!in_check && depth <= 2 && static_eval + (180 * depth) <= alpha) {
         result = quiescence(pos, alpha, beta, ply, 0, ctx);
@@ -1318,19 +1978,13 @@ static int negamax(const Position* pos, int depth, int alpha, int beta, int ply,
         beta < MATE_BOUND &&
         static_eval >= (beta + 70) &&
         side_has_non_pawn_material(pos, pos->side_to_move)) {
-        Position null_pos = *pos;
+        MoveUndo null_undo;
         int reduction = 2 + ((depth >= 7) ? 1 : 0);
         int score;
 
-        null_pos.side_to_move = (null_pos.side_to_move == SIDE_WHITE) ? SIDE_BLACK : SIDE_WHITE;
-        null_pos.en_passant_square = -1;
-        null_pos.halfmove_clock++;
-        if (null_pos.side_to_move == SIDE_WHITE) {
-            null_pos.fullmove_number++;
-        }
-        null_pos.zobrist_key = position_compute_zobrist(&null_pos);
-
-        score = -negamax(&null_pos, depth - 1 - reduction, -beta, -beta + 1, ply + 1, ctx);
+        engine_make_null_move(pos, &null_undo);
+        score = -negamax(pos, depth - 1 - reduction, -beta, -beta + 1, ply + 1, ctx);
+        engine_unmake_null_move(pos, &null_undo);
         if (ctx->stop) {
             result = 0;
             goto cleanup;
@@ -1341,40 +1995,30 @@ static int negamax(const Position* pos, int depth, int alpha, int beta, int ply,
         }
     }
 
-    generate_legal_moves(pos, &moves);
-    if (moves.count == 0) {
-        result = in_check ? (-MATE_SCORE + ply) : 0;
-        goto cleanup;
-    }
-
-    sort_moves(pos, &moves, tt_move, ctx, ply, false);
-    best_move = moves.moves[0];
+    picker_init(&picker, pos, ctx, tt_move, ply, in_check, false, false);
 
-    for (int i = 0; i < moves.count; ++i) {
-        Move move = moves.moves[i];
-        Position next = *pos;
+    while (picker_next(&picker, &move)) {
+        int i = move_index++;
+        MoveUndo undo;
         int child_depth = depth - 1;
         int score;
-        bool tactical = ((move.flags & MOVE_FLAG_CAPTURE) != 0U) || ((move.flags & MOVE_FLAG_PROMOTION) != 0U);
-        bool quiet_non_castle = !tactical &&
-            (move.flags & (MOVE_FLAG_KING_CASTLE | MOVE_FLAG_QUEEN_CASTLE)) == 0U;
+        bool quiet_non_castle = !PACKED_IS_TACTICAL(move) && !PACKED_IS_CASTLE(move);
         bool gives_check;
 
-        if (!engine_apply_move(&next, move)) {
+        if (!engine_make_packed(pos, move, &undo)) {
             continue;
         }
+        tt_prefetch(ctx->engine, pos->zobrist_key);
 
-        gives_check = engine_in_check(&next, next.side_to_move);
+        gives_check = engine_in_check(pos, pos->side_to_move);
 
         if (!in_check && !gives_check && quiet_non_castle && i > 0) {
             if (depth <= 2) {
                 int lmp_threshold = 8 + (depth * depth);
                 int futility_margin = 140 * depth + ((i >= 8) ? 50 : 0);
 
-                if (i >= lmp_threshold) {
-                    continue;
-                }
-                if (static_eval + futility_margin <= alpha) {
+                if (i >= lmp_threshold || static_eval + futility_margin <= alpha) {
+                    engine_unmake_packed(pos, move, &undo);
                     continue;
                 }
             }
@@ -1400,15 +2044,16 @@ static int negamax(const Position* pos, int depth, int alpha, int beta, int ply,
         }
 
         if (i == 0) {
-            score = -negamax(&next, child_depth, -beta, -alpha, ply + 1, ctx);
+            score = -negamax(pos, child_depth, -beta, -alpha, ply + 1, ctx);
         } else {
-            score = -negamax(&next, child_depth, -alpha - 1, -alpha, ply + 1, ctx);
+            score = -negamax(pos, child_depth, -alpha - 1, -alpha, ply + 1, ctx);
             if (!ctx->stop && score > alpha && score < beta) {
-                score = -negamax(&next, depth - 1, -beta, -alpha, ply + 1, ctx);
+                score = -negamax(pos, depth - 1, -beta, -alpha, ply + 1, ctx);
             } else if (!ctx->stop && child_depth != (depth - 1) && score > alpha) {
-                score = -negamax(&next, depth - 1, -beta, -alpha, ply + 1, ctx);
+                score = -negamax(pos, depth - 1, -beta, -alpha, ply + 1, ctx);
             }
         }
+        engine_unmake_packed(pos, move, &undo);
 
         if (ctx->stop) {
             result = 0;
@@ -1434,9 +2079,13 @@ static int negamax(const Position* pos, int depth, int alpha, int beta, int ply,
         }
     }
 
+    if (move_index == 0) {
+        result = in_check ? (-MATE_SCORE + ply) : 0;
+        goto cleanup;
+    }
+
     {
         uint8_t new_flag;
-        bool exact = false;
 
         if (best_score <= alpha_orig) {
             new_flag = TT_FLAG_UPPER;
@@ -1444,19 +2093,9 @@ static int negamax(const Position* pos, int depth, int alpha, int beta, int ply,
             new_flag = TT_FLAG_LOWER;
         } else {
             new_flag = TT_FLAG_EXACT;
-            exact = true;
         }
 
-        if (entry->key != pos->zobrist_key ||
-            depth + (exact ? 1 : 0) >= entry->depth ||
-            entry->generation != ctx->generation) {
-            entry->key = pos->zobrist_key;
-            entry->depth = depth;
-            entry->score = score_to_tt(best_score, ply);
-            entry->generation = ctx->generation;
-            entry->best_move = best_move;
-            entry->flag = new_flag;
-        }
+        tt_store(ctx->engine, pos->zobrist_key, depth, score_to_tt(best_score, ply), best_move, new_flag, ctx->generation);
     }
 
     result = best_score;
@@ -1469,14 +2108,15 @@ cleanup:
 }
 
 /* Quiescence search to stabilize tactical leaf evaluations. */
-static int quiescence(const Position* pos, int alpha, int beta, int ply, int qdepth, SearchContext* ctx) {
+static int quiescence(Position* pos, int alpha, int beta, int ply, int qdepth, SearchContext* ctx) {
     int result = 0;
     bool pushed = false;
     bool in_check;
-    MoveList moves;
+    MovePicker picker;
+    PackedMove move;
     int stand_pat;
     int best_score;
-    Move tt_move = {0};
+    PackedMove tt_move = PACKED_MOVE_NONE;
 
     if (search_should_stop(ctx)) {
         return 0;
@@ -1491,10 +2131,11 @@ static int quiescence(const Position* pos, int alpha, int beta, int ply, int qde
     }
 
     if (ply >= MAX_HISTORY_PLY - 1) {
-        return evaluate_for_side(pos);
+        return evaluate_cached(pos, ctx);
     }
 
     ctx->nodes++;
+    ctx->qnodes++;
 
     if (ctx->path_len < MAX_HISTORY_PLY) {
         ctx->path_keys[ctx->path_len++] = pos->zobrist_key;
@@ -1502,7 +2143,7 @@ static int quiescence(const Position* pos, int alpha, int beta, int ply, int qde
     }
 
     in_check = engine_in_check(pos, pos->side_to_move);
-    stand_pat = evaluate_for_side(pos);
+    stand_pat = evaluate_cached(pos, ctx);
     best_score = stand_pat;
 
     if (!in_check) {
@@ -1515,48 +2156,42 @@ static int quiescence(const Position* pos, int alpha, int beta, int ply, int qde
         }
     }
 
-    generate_legal_moves(pos, &moves);
-    if (moves.count == 0) {
-        result = in_check ? (-MATE_SCORE + ply) : 0;
-        goto cleanup;
-    }
-
-    sort_moves(pos, &moves, tt_move, ctx, ply, true);
+    picker_init(&picker, pos, ctx, tt_move, ply, in_check, true, qdepth < 2);
 
-    for (int i = 0; i < moves.count; ++i) {
-        Move move = moves.moves[i];
-        Position next = *pos;
+    while (picker_next(&picker, &move)) {
+        MoveUndo undo;
         int score;
-        bool tactical = ((move.flags & MOVE_FLAG_CAPTURE) != 0U) ||
-                        ((move.flags & MOVE_FLAG_PROMOTION) != 0U);
+        bool tactical = PACKED_IS_TACTICAL(move);
 
         if (!in_check && !tactical) {
             if (qdepth >= 2) {
                 continue;
             }
-            if ((move.flags & (MOVE_FLAG_KING_CASTLE | MOVE_FLAG_QUEEN_CASTLE)) != 0U) {
+            if (PACKED_IS_CASTLE(move)) {
                 continue;
             }
         }
 
         if (!in_check &&
-            (move.flags & MOVE_FLAG_CAPTURE) != 0U &&
-            (move.flags & MOVE_FLAG_PROMOTION) == 0U) {
+            PACKED_IS_CAPTURE(move) &&
+            !PACKED_IS_PROMOTION(move)) {
             int capture_gain = score_capture(pos, move) / 16;
             if (stand_pat + capture_gain + 90 < alpha) {
                 continue;
             }
         }
 
-        if (!engine_apply_move(&next, move)) {
+        if (!engine_make_packed(pos, move, &undo)) {
             continue;
         }
 
-        if (!in_check && !tactical && !engine_in_check(&next, next.side_to_move)) {
+        if (!in_check && !tactical && !engine_in_check(pos, pos->side_to_move)) {
+            engine_unmake_packed(pos, move, &undo);
             continue;
         }
 
-        score = -quiescence(&next, -beta, -alpha, ply + 1, qdepth + 1, ctx);
+        score = -quiescence(pos, -beta, -alpha, ply + 1, qdepth + 1, ctx);
+        engine_unmake_packed(pos, move, &undo);
         if (ctx->stop) {
             result = 0;
             goto cleanup;
@@ -1573,6 +2208,12 @@ static int quiescence(const Position* pos, int alpha, int beta, int ply, int qde
         }
     }
 
+    /* With a full (or evasion) list, no moves means mate or stalemate; captures-only lists prove nothing. */
+    if (picker.complete && picker.moves.count == 0) {
+        result = in_check ? (-MATE_SCORE + ply) : 0;
+        goto cleanup;
+    }
+
     result = best_score;
 
 cleanup:
@@ -1582,80 +2223,114 @@ cleanup:
     return result;
 }
 
-/* Clears transposition table content. */
-void engine_reset_transposition_table(void) {
-    memset(g_tt, 0, sizeof(g_tt));
-    g_tt_generation = 1;
+static int clamp_hash_size(int size_mb) {
+    if (size_mb < 1) {
+        return 1;
+    }
+    if (size_mb > TT_MAX_SIZE_MB) {
+        return TT_MAX_SIZE_MB;
+    }
+    return size_mb;
 }
 
-/* Iterative deepening root search with optional move-randomness window. */
-void search_best_move(const Position* pos, const SearchLimits* limits, SearchResult* out_result) {
-    SearchLimits local_limits;
-    SearchContext ctx;
-    MoveList root_moves;
-    SearchResult result;
-    Move best_move;
-    int best_score = -INF_SCORE;
-    int root_scores[MAX_MOVES];
+Engine* engine_create(int hash_mb) {
+    Engine* engine = (Engine*)calloc(1U, sizeof(*engine));
 
-    if (pos == NULL || limits == NULL || out_result == NULL) {
-        return;
+    if (engine == NULL) {
+        return NULL;
     }
+    engine->tt_size_mb = (hash_mb > 0) ? clamp_hash_size(hash_mb) : TT_DEFAULT_SIZE_MB;
+    engine->tt_generation = 1;
+    return engine;
+}
 
-    local_limits = *limits;
-    if (local_limits.depth < SEARCH_MIN_DEPTH) {
-        local_limits.depth = SEARCH_MIN_DEPTH;
+void engine_destroy(Engine* engine) {
+    if (engine == NULL || engine == &g_default_engine) {
+        return;
     }
-    if (local_limits.depth > SEARCH_MAX_DEPTH) {
-        local_limits.depth = SEARCH_MAX_DEPTH;
+    tt_release(engine);
+    free(engine);
+}
+
+/* Clears transposition table and eval cache content. */
+void engine_clear(Engine* engine) {
+    for (uint32_t i = 0; i < EVAL_CACHE_ENTRIES; ++i) {
+        atomic_store_explicit(&engine->eval_cache[i], 0ULL, memory_order_relaxed);
     }
-    if (local_limits.randomness < 0) {
-        local_limits.randomness = 0;
+    if (engine->tt != NULL) {
+        tt_clear(engine);
+    } else {
+        (void)tt_ensure(engine);
     }
+    engine->tt_generation = 1;
+}
 
-    memset(&ctx, 0, sizeof(ctx));
-    ctx.limits = local_limits;
-    ctx.start_ms = now_ms();
-    g_tt_generation++;
-    if (g_tt_generation == 0U) {
-        g_tt_generation = 1U;
+/* Resizes (and clears) the transposition table; must not run concurrently with a search. */
+bool engine_resize_hash(Engine* engine, int size_mb) {
+    if (!tt_allocate(engine, clamp_hash_size(size_mb))) {
+        return false;
     }
-    ctx.generation = g_tt_generation;
-    ctx.path_keys[0] = pos->zobrist_key;
-    ctx.path_len = 1;
+    engine->tt_generation = 1;
+    return true;
+}
 
-    memset(&result, 0, sizeof(result));
-    result.best_move.promotion = PIECE_NONE;
+int engine_hash_size(const Engine* engine) {
+    return engine->tt_size_mb;
+}
 
-    if (opening_book_pick_move(pos, local_limits.randomness, &result.best_move)) {
-        Position next = *pos;
-        if (engine_apply_move(&next, result.best_move)) {
-            result.score = -evaluate_for_side(&next);
-        } else {
-            result.score = 0;
-        }
-        result.depth_reached = 0;
-        result.nodes = 0;
-        *out_result = result;
-        return;
-    }
+void engine_reset_transposition_table(void) {
+    engine_clear(&g_default_engine);
+}
 
-    generate_legal_moves(pos, &root_moves);
+bool engine_set_hash_size(int size_mb) {
+    return engine_resize_hash(&g_default_engine, size_mb);
+}
 
-    if (root_moves.count == 0) {
-        *out_result = result;
-        return;
-    }
+int engine_get_hash_size(void) {
+    return engine_hash_size(&g_default_engine);
+}
+
+bool engine_hash_uses_huge_pages(void) {
+    return g_default_engine.tt_huge_pages;
+}
+
+/*
+ * One Lazy SMP search thread. Every worker runs its own iterative deepening
+ * over the same root with private killers/history; they cooperate only
+ * through the shared transposition table.
+ */
+typedef struct SearchWorker {
+    SearchContext ctx;
+    Position root;
+    PackedMoveList root_moves;
+    int root_scores[MAX_MOVES];
+    PackedMove best_move;
+    int best_score;
+    int depth_reached;
+    ChessFuture* future;
+} SearchWorker;
+
+/* Iterative deepening with aspiration windows for one worker. */
+static void search_iterate(SearchWorker* worker) {
+    SearchContext* ctx = &worker->ctx;
+    Position* root = &worker->root;
+    PackedMoveList* root_moves = &worker->root_moves;
+    int order_scores[MAX_MOVES];
+    int best_score = -INF_SCORE;
+    /* Odd helpers run one ply ahead so the threads spread over neighbouring depths. */
+    int start_depth = SEARCH_MIN_DEPTH + (ctx->thread_id & 1);
 
     for (int i = 0; i < MAX_MOVES; ++i) {
-        root_scores[i] = -INF_SCORE;
+        worker->root_scores[i] = -INF_SCORE;
     }
 
-    best_move = root_moves.moves[0];
+    worker->best_move = root_moves->moves[0];
+    worker->best_score = -INF_SCORE;
+    worker->depth_reached = 0;
 
-    for (int depth = 1; depth <= local_limits.depth; ++depth) {
-        Move tt_move = {0};
-        TTEntry* root_entry = &g_tt[pos->zobrist_key & (TT_SIZE - 1)];
+    for (int depth = start_depth; depth <= ctx->limits.depth; ++depth) {
+        PackedMove tt_move = PACKED_MOVE_NONE;
+        TTData root_entry;
         int aspiration_window = ASPIRATION_BASE_WINDOW + (depth * 8);
         bool use_aspiration = (depth >= ASPIRATION_MIN_DEPTH &&
                                best_score > -MATE_BOUND &&
@@ -1664,14 +2339,14 @@ void search_best_move(const Position* pos, const SearchLimits* limits, SearchRes
         int beta = INF_SCORE;
         bool depth_completed = false;
         int depth_completed_score = -INF_SCORE;
-        Move depth_completed_move = root_moves.moves[0];
+        PackedMove depth_completed_move = root_moves->moves[0];
 
-        if (search_should_stop(&ctx)) {
+        if (search_should_stop(ctx)) {
             break;
         }
 
-        if (root_entry->key == pos->zobrist_key) {
-            tt_move = root_entry->best_move;
+        if (tt_probe(ctx->engine, root->zobrist_key, &root_entry)) {
+            tt_move = root_entry.best_move;
         }
 
         if (use_aspiration) {
@@ -1687,43 +2362,48 @@ void search_best_move(const Position* pos, const SearchLimits* limits, SearchRes
         }
 
         while (true) {
-            MoveList depth_moves = root_moves;
+            PackedMoveList depth_moves = *root_moves;
             int depth_best_score = -INF_SCORE;
-            Move depth_best_move = depth_moves.moves[0];
+            PackedMove depth_best_move = depth_moves.moves[0];
             bool completed = false;
             int search_alpha = alpha;
             int search_beta = beta;
 
-            sort_moves(pos, &depth_moves, tt_move, &ctx, 0, false);
+            sort_moves(root, &depth_moves, order_scores, tt_move, ctx, 0);
             if (depth > 1) {
-                sort_root_moves_by_previous_scores(&depth_moves, &root_moves, root_scores);
+                sort_root_moves_by_previous_scores(&depth_moves, root_moves, worker->root_scores);
+            }
+            if (ctx->thread_id > 0 && depth_moves.count > 2) {
+                rotate_root_tail(&depth_moves, ctx->thread_id);
             }
 
             for (int i = 0; i < depth_moves.count; ++i) {
-                Position next = *pos;
+                MoveUndo undo;
                 int score;
 
-                if (!engine_apply_move(&next, depth_moves.moves[i])) {
+                if (!engine_make_packed(root, depth_moves.moves[i], &undo)) {
                     continue;
                 }
+                tt_prefetch(ctx->engine, root->zobrist_key);
 
                 if (i == 0) {
-                    score = -negamax(&next, depth - 1, -search_beta, -search_alpha, 1, &ctx);
+                    score = -negamax(root, depth - 1, -search_beta, -search_alpha, 1, ctx);
                 } else {
-                    score = -negamax(&next, depth - 1, -search_alpha - 1, -search_alpha, 1, &ctx);
-                    if (!ctx.stop && score > search_alpha && score < search_beta) {
-                        score = -negamax(&next, depth - 1, -search_beta, -search_alpha, 1, &ctx);
+                    score = -negamax(root, depth - 1, -search_alpha - 1, -search_alpha, 1, ctx);
+                    if (!ctx->stop && score > search_alpha && score < search_beta) {
+                        score = -negamax(root, depth - 1, -search_beta, -search_alpha, 1, ctx);
                     }
                 }
-                if (ctx.stop) {
+                engine_unmake_packed(root, depth_moves.moves[i], &undo);
+                if (ctx->stop) {
                     break;
                 }
 
                 completed = true;
 
-                for (int m = 0; m < root_moves.count; ++m) {
-                    if (move_same(root_moves.moves[m], depth_moves.moves[i])) {
-                        root_scores[m] = score;
+                for (int m = 0; m < root_moves->count; ++m) {
+                    if (root_moves->moves[m] == depth_moves.moves[i]) {
+                        worker->root_scores[m] = score;
                         break;
                     }
                 }
@@ -1742,7 +2422,7 @@ void search_best_move(const Position* pos, const SearchLimits* limits, SearchRes
                 }
             }
 
-            if (ctx.stop || !completed) {
+            if (ctx->stop || !completed) {
                 depth_completed = false;
                 break;
             }
@@ -1778,26 +2458,185 @@ void search_best_move(const Position* pos, const SearchLimits* limits, SearchRes
             break;
         }
 
-        if (ctx.stop || !depth_completed) {
+        if (ctx->stop || !depth_completed) {
             break;
         }
 
         best_score = depth_completed_score;
-        best_move = depth_completed_move;
-        result.depth_reached = depth;
+        worker->best_score = depth_completed_score;
+        worker->best_move = depth_completed_move;
+        worker->depth_reached = depth;
+
+        /*
+         * The main thread owns budget decisions: skip a depth that cannot finish in time or
+         * inside the node budget. Pondering suspends the clock but not the node budget.
+         */
+        if (ctx->thread_id == 0) {
+            bool pondering = ctx->ponder_flag != NULL &&
+                             atomic_load_explicit(ctx->ponder_flag, memory_order_relaxed);
+
+            time_manager_iteration_done(&ctx->time, ctx->nodes, depth_completed_move, depth_completed_score);
+            if ((!pondering || ctx->limits.max_nodes > 0ULL) &&
+                !time_manager_next_iteration_fits(&ctx->time, ctx->nodes)) {
+                break;
+            }
+        }
+    }
+}
+
+static void* search_helper_main(void* arg) {
+    search_iterate((SearchWorker*)arg);
+    return NULL;
+}
+
+/*
+ * Iterative deepening root search with optional Lazy SMP helpers and move-randomness window.
+ * Raising *abort_flag (may be NULL) ends it early with the best move of the last completed depth;
+ * while *ponder_flag (may be NULL) is raised the time limit is suspended.
+ */
+static void search_run(Engine* engine,
+                       const Position* pos,
+                       const SearchLimits* limits,
+                       atomic_bool* abort_flag,
+                       atomic_bool* ponder_flag,
+                       SearchResult* out_result) {
+    SearchLimits local_limits;
+    SearchWorker main_worker;
+    SearchWorker* helpers = NULL;
+    SearchWorker* chosen;
+    atomic_bool shared_stop;
+    PackedMoveList root_moves;
+    SearchResult result;
+    PackedMove best_move;
+    int best_score;
+    int helper_count = 0;
+    uint8_t generation;
+
+    if (engine == NULL || pos == NULL || limits == NULL || out_result == NULL) {
+        return;
+    }
+
+    local_limits = *limits;
+    if (local_limits.depth < SEARCH_MIN_DEPTH) {
+        local_limits.depth = SEARCH_MIN_DEPTH;
+    }
+    if (local_limits.depth > SEARCH_MAX_DEPTH) {
+        local_limits.depth = SEARCH_MAX_DEPTH;
+    }
+    if (local_limits.randomness < 0) {
+        local_limits.randomness = 0;
+    }
+    if (local_limits.threads < 1) {
+        local_limits.threads = 1;
+    }
+    if (local_limits.threads > SEARCH_MAX_THREADS) {
+        local_limits.threads = SEARCH_MAX_THREADS;
+    }
+
+    engine->tt_generation = (uint8_t)((engine->tt_generation + 1U) & TT_GENERATION_MASK);
+    if (engine->tt_generation == 0U) {
+        engine->tt_generation = 1U;
+    }
+    generation = engine->tt_generation;
+
+    memset(&result, 0, sizeof(result));
+    result.best_move.promotion = PIECE_NONE;
+
+    if (opening_book_pick_move(pos, local_limits.randomness, &result.best_move)) {
+        Position next = *pos;
+        if (engine_apply_move(&next, result.best_move)) {
+            result.score = -evaluate_for_side(&next, NULL);
+        } else {
+            result.score = 0;
+        }
+        result.depth_reached = 0;
+        result.nodes = 0;
+        *out_result = result;
+        return;
     }
 
-    if (!ctx.stop &&
+    engine_generate_legal_packed(pos, &root_moves);
+
+    if (root_moves.count == 0 || !tt_ensure(engine)) {
+        *out_result = result;
+        return;
+    }
+
+    atomic_init(&shared_stop, false);
+    memset(&main_worker, 0, sizeof(main_worker));
+    main_worker.ctx.engine = engine;
+    main_worker.ctx.limits = local_limits;
+    time_manager_init(&main_worker.ctx.time, &local_limits);
+    main_worker.ctx.generation = generation;
+    main_worker.ctx.shared_stop = &shared_stop;
+    main_worker.ctx.abort_flag = abort_flag;
+    main_worker.ctx.ponder_flag = ponder_flag;
+    main_worker.ctx.path_keys[0] = pos->zobrist_key;
+    main_worker.ctx.path_len = 1;
+    main_worker.root = *pos;
+    main_worker.root_moves = root_moves;
+
+    if (local_limits.threads > 1) {
+        helpers = (SearchWorker*)calloc((size_t)(local_limits.threads - 1), sizeof(SearchWorker));
+        if (helpers != NULL) {
+            helper_count = local_limits.threads - 1;
+        }
+    }
+
+    /*
+     * Helpers run on the shared pool, but only on workers that are idle now: a helper queued
+     * behind other jobs would start after the main thread is done. The count shrinks to fit.
+     */
+    for (int i = 0; i < helper_count; ++i) {
+        helpers[i] = main_worker;
+        helpers[i].ctx.thread_id = i + 1;
+        helpers[i].future = chess_pool_submit_if_idle(chess_pool_shared(), search_helper_main, &helpers[i]);
+        if (helpers[i].future == NULL) {
+            helper_count = i;
+            break;
+        }
+    }
+    result.helper_threads = helper_count;
+
+    search_iterate(&main_worker);
+
+    atomic_store(&shared_stop, true);
+    result.nodes = main_worker.ctx.nodes;
+    result.pawn_hash_probes = main_worker.ctx.pawn_probes;
+    result.pawn_hash_hits = main_worker.ctx.pawn_hits;
+    result.eval_cache_probes = main_worker.ctx.eval_probes;
+    result.eval_cache_hits = main_worker.ctx.eval_hits;
+    result.qsearch_nodes = main_worker.ctx.qnodes;
+    chosen = &main_worker;
+    for (int i = 0; i < helper_count; ++i) {
+        (void)chess_future_wait(helpers[i].future);
+        result.nodes += helpers[i].ctx.nodes;
+        result.pawn_hash_probes += helpers[i].ctx.pawn_probes;
+        result.pawn_hash_hits += helpers[i].ctx.pawn_hits;
+        result.eval_cache_probes += helpers[i].ctx.eval_probes;
+        result.eval_cache_hits += helpers[i].ctx.eval_hits;
+        result.qsearch_nodes += helpers[i].ctx.qnodes;
+        /* Prefer a helper only when it completed a strictly deeper iteration. */
+        if (helpers[i].depth_reached > chosen->depth_reached) {
+            chosen = &helpers[i];
+        }
+    }
+
+    best_move = chosen->best_move;
+    best_score = chosen->best_score;
+    result.depth_reached = chosen->depth_reached;
+
+    if (!main_worker.ctx.stop &&
         local_limits.randomness > 0 &&
         root_moves.count > 1 &&
         best_score > -MATE_BOUND &&
         best_score < MATE_BOUND) {
-        Move candidates[MAX_MOVES];
+        PackedMove candidates[MAX_MOVES];
         int candidate_count = 0;
 
         for (int i = 0; i < root_moves.count; ++i) {
-            if (root_scores[i] > -INF_SCORE / 2 &&
-                root_scores[i] >= (best_score - local_limits.randomness)) {
+            if (chosen->root_scores[i] > -INF_SCORE / 2 &&
+                chosen->root_scores[i] >= (best_score - local_limits.randomness)) {
                 candidates[candidate_count++] = root_moves.moves[i];
             }
         }
@@ -1807,18 +2646,148 @@ void search_best_move(const Position* pos, const SearchLimits* limits, SearchRes
         }
     }
 
+    free(helpers);
+
+    result.best_move = engine_unpack_move(best_move);
     if (best_score == -INF_SCORE) {
         Position next = *pos;
-        if (engine_apply_move(&next, best_move)) {
-            best_score = -evaluate_for_side(&next);
+        if (engine_apply_move(&next, result.best_move)) {
+            best_score = -evaluate_for_side(&next, NULL);
         } else {
             best_score = 0;
         }
     }
 
-    result.best_move = best_move;
     result.score = best_score;
-    result.nodes = ctx.nodes;
+
+    /* Expected reply (for pondering): the TT move of the position after our best move. */
+    {
+        Position next = *pos;
+        MoveUndo undo;
+        TTData reply;
+
+        if (engine_make_packed(&next, best_move, &undo) &&
+            tt_probe(engine, next.zobrist_key, &reply) &&
+            reply.best_move != PACKED_MOVE_NONE &&
+            engine_packed_is_legal(&next, reply.best_move)) {
+            result.ponder_move = engine_unpack_move(reply.best_move);
+            result.has_ponder_move = true;
+        }
+    }
 
     *out_result = result;
 }
+
+void engine_search(Engine* engine, const Position* pos, const SearchLimits* limits, SearchResult* out_result) {
+    search_run(engine, pos, limits, NULL, NULL, out_result);
+}
+
+void search_best_move(const Position* pos, const SearchLimits* limits, SearchResult* out_result) {
+    search_run(&g_default_engine, pos, limits, NULL, NULL, out_result);
+}
+
+/* Background search state; `running` drops once the result is published, `future` stays waitable. */
+struct SearchHandle {
+    Engine* engine;
+    Position position;
+    SearchLimits limits;
+    SearchResult result;
+    atomic_bool stop;
+    atomic_bool ponder;
+    atomic_bool running;
+    ChessFuture* future;
+};
+
+/* Search-handle task, run on the shared pool. */
+static void* search_handle_main(void* arg) {
+    SearchHandle* handle = (SearchHandle*)arg;
+
+    search_run(handle->engine, &handle->position, &handle->limits, &handle->stop, &handle->ponder, &handle->result);
+    atomic_store(&handle->running, false);
+    return NULL;
+}
+
+SearchHandle* search_handle_create_for(Engine* engine) {
+    SearchHandle* handle = (SearchHandle*)calloc(1U, sizeof(*handle));
+
+    if (handle == NULL) {
+        return NULL;
+    }
+    handle->engine = (engine != NULL) ? engine : &g_default_engine;
+    atomic_init(&handle->stop, false);
+    atomic_init(&handle->ponder, false);
+    atomic_init(&handle->running, false);
+    return handle;
+}
+
+SearchHandle* search_handle_create(void) {
+    return search_handle_create_for(NULL);
+}
+
+void search_handle_destroy(SearchHandle* handle) {
+    if (handle == NULL) {
+        return;
+    }
+    search_stop(handle);
+    (void)search_wait(handle, NULL);
+    free(handle);
+}
+
+/* Shared by search_start and search_start_ponder. */
+static bool search_handle_launch(SearchHandle* handle, const Position* pos, const SearchLimits* limits, bool ponder) {
+    if (handle == NULL || pos == NULL || limits == NULL || handle->future != NULL) {
+        return false;
+    }
+
+    handle->position = *pos;
+    handle->limits = *limits;
+    memset(&handle->result, 0, sizeof(handle->result));
+    handle->result.best_move.promotion = PIECE_NONE;
+    atomic_store(&handle->stop, false);
+    atomic_store(&handle->ponder, ponder);
+    atomic_store(&handle->running, true);
+
+    handle->future = chess_pool_submit(chess_pool_shared(), search_handle_main, handle);
+    if (handle->future == NULL) {
+        atomic_store(&handle->running, false);
+        return false;
+    }
+    return true;
+}
+
+bool search_start(SearchHandle* handle, const Position* pos, const SearchLimits* limits) {
+    return search_handle_launch(handle, pos, limits, false);
+}
+
+bool search_start_ponder(SearchHandle* handle, const Position* pos, const SearchLimits* limits) {
+    return search_handle_launch(handle, pos, limits, true);
+}
+
+void search_ponderhit(SearchHandle* handle) {
+    if (handle != NULL) {
+        atomic_store(&handle->ponder, false);
+    }
+}
+
+void search_stop(SearchHandle* handle) {
+    if (handle != NULL) {
+        atomic_store(&handle->stop, true);
+    }
+}
+
+bool search_is_running(SearchHandle* handle) {
+    return handle != NULL && atomic_load(&handle->running);
+}
+
+bool search_wait(SearchHandle* handle, SearchResult* out_result) {
+    if (handle == NULL || handle->future == NULL) {
+        return false;
+    }
+
+    (void)chess_future_wait(handle->future);
+    handle->future = NULL;
+    if (out_result != NULL) {
+        *out_result = handle->result;
+    }
+    return true;
+}
@@ -0,0 +1,178 @@
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "engine_internal.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/* Reserved per move for GUI/thread latency so the hard limit is met on the wall clock. */
+#define TIME_MOVE_OVERHEAD_MS 20
+/* Sudden-death games are budgeted as if this many moves remained. */
+#define TIME_DEFAULT_MOVES_TO_GO 30
+#define TIME_MAX_MOVES_TO_GO 50
+/* The hard limit may stretch the soft one this far, but never past this share of the clock. */
+#define TIME_HARD_SOFT_RATIO 5
+#define TIME_HARD_CLOCK_PERCENT 80
+/* Branching-factor prediction bounds (x10) and the default before two iterations are timed. */
+#define TIME_EBF_MIN_X10 15
+#define TIME_EBF_MAX_X10 50
+#define TIME_EBF_DEFAULT_X10 25
+/* A root score drop of this many centipawns counts like a best-move change. */
+#define TIME_SCORE_DROP_CP 40
+
+/* Monotonic milliseconds; unaffected by wall-clock adjustments. */
+uint64_t engine_clock_ms(void) {
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+#endif
+}
+
+void time_manager_init(TimeManager* tm, const SearchLimits* limits) {
+    int soft = 0;
+    int hard = 0;
+
+    tm->start_ms = engine_clock_ms();
+    tm->iteration_start_ms = tm->start_ms;
+    tm->last_iteration_ms = 0;
+    tm->prev_iteration_ms = 0;
+    tm->instability = 0;
+    tm->stable_iterations = 0;
+    tm->last_best = PACKED_MOVE_NONE;
+    tm->last_score = 0;
+    tm->has_iteration = false;
+    tm->max_nodes = limits->max_nodes;
+    tm->iteration_start_nodes = 0ULL;
+    tm->last_iteration_nodes = 0ULL;
+    tm->prev_iteration_nodes = 0ULL;
+
+    if (limits->time_left_ms > 0) {
+        int moves_to_go = (limits->moves_to_go > 0) ? limits->moves_to_go : TIME_DEFAULT_MOVES_TO_GO;
+        int available = limits->time_left_ms - TIME_MOVE_OVERHEAD_MS;
+        int increment = (limits->increment_ms > 0) ? limits->increment_ms : 0;
+
+        if (moves_to_go > TIME_MAX_MOVES_TO_GO) {
+            moves_to_go = TIME_MAX_MOVES_TO_GO;
+        }
+        if (available < 1) {
+            available = 1;
+        }
+        soft = available / moves_to_go + (increment * 3) / 4;
+        hard = (int)(((int64_t)available * TIME_HARD_CLOCK_PERCENT) / 100);
+        if ((int64_t)soft * TIME_HARD_SOFT_RATIO < hard) {
+            hard = soft * TIME_HARD_SOFT_RATIO;
+        }
+        if (hard < 1) {
+            hard = 1;
+        }
+        if (soft > hard) {
+            soft = hard;
+        }
+    }
+
+    /* A fixed move time caps both limits (and is the only limit without a clock). */
+    if (limits->max_time_ms > 0) {
+        if (hard == 0 || limits->max_time_ms < hard) {
+            hard = limits->max_time_ms;
+        }
+        if (soft == 0 || limits->max_time_ms < soft) {
+            soft = limits->max_time_ms;
+        }
+    }
+
+    tm->soft_ms = soft;
+    tm->hard_ms = hard;
+}
+
+bool time_manager_expired(const TimeManager* tm) {
+    return tm->hard_ms > 0 && (engine_clock_ms() - tm->start_ms) >= (uint64_t)tm->hard_ms;
+}
+
+void time_manager_iteration_done(TimeManager* tm, uint64_t nodes, PackedMove best, int score) {
+    uint64_t now = engine_clock_ms();
+
+    tm->prev_iteration_ms = tm->last_iteration_ms;
+    tm->last_iteration_ms = (int)(now - tm->iteration_start_ms);
+    tm->iteration_start_ms = now;
+    tm->prev_iteration_nodes = tm->last_iteration_nodes;
+    tm->last_iteration_nodes = nodes - tm->iteration_start_nodes;
+    tm->iteration_start_nodes = nodes;
+
+    /* Old changes fade by half per iteration; a new best move or a sharp score drop adds one. */
+    tm->instability /= 2;
+    if (tm->has_iteration) {
+        if (best != tm->last_best) {
+            tm->instability += 100;
+            tm->stable_iterations = 0;
+        } else {
+            tm->stable_iterations++;
+        }
+        if (score < tm->last_score - TIME_SCORE_DROP_CP) {
+            tm->instability += 100;
+        }
+    }
+    tm->last_best = best;
+    tm->last_score = score;
+    tm->has_iteration = true;
+}
+
+/* Next iteration ~ the last one times the branching factor seen between the last two (x10, clamped). */
+static uint64_t predict_next_iteration(uint64_t last, uint64_t prev) {
+    uint64_t ebf_x10 = TIME_EBF_DEFAULT_X10;
+
+    if (prev > 0ULL) {
+        ebf_x10 = (last * 10ULL) / prev;
+        if (ebf_x10 < TIME_EBF_MIN_X10) {
+            ebf_x10 = TIME_EBF_MIN_X10;
+        }
+        if (ebf_x10 > TIME_EBF_MAX_X10) {
+            ebf_x10 = TIME_EBF_MAX_X10;
+        }
+    }
+    return (last * ebf_x10) / 10ULL;
+}
+
+bool time_manager_next_iteration_fits(const TimeManager* tm, uint64_t nodes) {
+    int elapsed;
+    int soft;
+
+    /* Node budgets are checked first so node-limited play never depends on the clock. */
+    if (tm->max_nodes > 0ULL &&
+        nodes + predict_next_iteration(tm->last_iteration_nodes, tm->prev_iteration_nodes) > tm->max_nodes) {
+        return false;
+    }
+    if (tm->hard_ms <= 0) {
+        return true;
+    }
+
+    elapsed = (int)(engine_clock_ms() - tm->start_ms);
+
+    /* Unstable roots earn up to 2.5x the soft budget; a long-settled best move gets 70%. */
+    soft = tm->soft_ms;
+    if (tm->instability > 0) {
+        int scale = 100 + (tm->instability > 150 ? 150 : tm->instability);
+        soft = (int)(((int64_t)soft * scale) / 100);
+    } else if (tm->stable_iterations >= 4) {
+        soft = (soft * 7) / 10;
+    }
+    if (soft > tm->hard_ms) {
+        soft = tm->hard_ms;
+    }
+    if (elapsed >= soft) {
+        return false;
+    }
+
+    return (uint64_t)elapsed +
+               predict_next_iteration((uint64_t)tm->last_iteration_ms, (uint64_t)tm->prev_iteration_ms) <=
+           (uint64_t)tm->hard_ms;
+}
@@ -1,15 +1,20 @@
 #include "engine.h"
+#include "engine_internal.h"
+#include "task_scheduler.h"
+#include "threading.h"
 
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#ifdef _WIN32
-#include <windows.h>
-#else
-#include <sys/time.h>
-#endif
+#define PERFT_MAX_THREADS 64
+#define PERFT_DEFAULT_HASH_MB 64
+/* Depth-1 nodes are bulk-counted from the move list, so hashing starts one ply above. */
+#define PERFT_HASH_MIN_DEPTH 2
+/* Perft subtrees this shallow are counted on one thread; deeper nodes spawn a task per move. */
+#define PERFT_SERIAL_DEPTH 2
 
 typedef struct PerftCase {
     const char* name;
@@ -26,6 +31,13 @@ typedef struct TacticalCase {
     const char* expected_moves;
 } TacticalCase;
 
+typedef struct SearchSpeedCase {
+    const char* name;
+    const char* fen;
+    int depth;
+    int quick_depth;
+} SearchSpeedCase;
+
 static const PerftCase g_perft_cases_full[] = {
     {
         "Start Position D5",
@@ -50,6 +62,36 @@ static const PerftCase g_perft_cases_full[] = {
         "r3k2r/Pppp1ppp/1b3nbN/nP6/B1P1P3/5N2/Pp1P1PPP/R2Q1RK1 w kq - 0 1",
         4,
         1371859ULL
+    },
+    {
+        "Promotion Tangle D4",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        4,
+        2103487ULL
+    },
+    {
+        "Symmetric Middlegame D4",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        4,
+        3894594ULL
+    },
+    {
+        "Rank-Pinned EP D6",
+        "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1",
+        6,
+        1134888ULL
+    },
+    {
+        "Diagonal-Pinned EP D6",
+        "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+        6,
+        1440467ULL
+    },
+    {
+        "Castle Through Check D4",
+        "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1",
+        4,
+        1720476ULL
     }
 };
 
@@ -71,6 +113,52 @@ static const PerftCase g_perft_cases_quick[] = {
         "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
         4,
         43238ULL
+    },
+    {
+        "Promotion Tangle D3",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        3,
+        62379ULL
+    },
+    {
+        "Diagonal-Pinned EP D5",
+        "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+        5,
+        206379ULL
+    }
+};
+
+/* Depth 6-7 regression gate; only practical with the parallel hashed perft. */
+static const PerftCase g_perft_cases_deep[] = {
+    {
+        "Start Position D6",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        6,
+        119060324ULL
+    },
+    {
+        "Kiwipete D5",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        5,
+        193690690ULL
+    },
+    {
+        "Endgame EP D7",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        7,
+        178633661ULL
+    },
+    {
+        "Position 4 D5",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        5,
+        15833292ULL
+    },
+    {
+        "Promotion Tangle D5",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        5,
+        89941194ULL
     }
 };
 
@@ -105,19 +193,52 @@ static const TacticalCase g_tactical_cases[] = {
     }
 };
 
-/* Portable monotonic-ish millisecond clock for benchmark reporting. */
-static uint64_t now_ms(void) {
-#ifdef _WIN32
-    return (uint64_t)GetTickCount64();
-#else
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (uint64_t)tv.tv_sec * 1000ULL + (uint64_t)(tv.tv_usec / 1000ULL);
-#endif
+/* Fixed-depth searches (outside the opening book) timed to report time-to-depth and nps. */
+static const SearchSpeedCase g_search_speed_cases[] = {
+    {"Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 7, 5},
+    {"Italian Middlegame", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 7, 5},
+    {"Rook Endgame", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 10, 7}
+};
+
+/* Converts a node count and elapsed time into nodes per second. */
+static uint64_t nodes_per_second(uint64_t nodes, uint64_t elapsed_ms) {
+    return (nodes * 1000ULL) / (elapsed_ms > 0ULL ? elapsed_ms : 1ULL);
+}
+
+/* Hit rate in parts per thousand (0 when nothing was probed). */
+static uint64_t per_mille(uint64_t hits, uint64_t probes) {
+    return (probes > 0ULL) ? (hits * 1000ULL) / probes : 0ULL;
+}
+
+/* Returns nodes count for one legal perft subtree (packed moves, in-place make/unmake). */
+static uint64_t perft_recursive(Position* pos, int depth) {
+    PackedMoveList legal;
+    uint64_t nodes = 0ULL;
+
+    if (depth <= 0) {
+        return 1ULL;
+    }
+
+    engine_generate_legal_packed(pos, &legal);
+    if (depth == 1) {
+        return (uint64_t)legal.count;
+    }
+
+    for (int i = 0; i < legal.count; ++i) {
+        MoveUndo undo;
+
+        if (!engine_make_packed(pos, legal.moves[i], &undo)) {
+            continue;
+        }
+        nodes += perft_recursive(pos, depth - 1);
+        engine_unmake_packed(pos, legal.moves[i], &undo);
+    }
+
+    return nodes;
 }
 
-/* Returns nodes count for one legal perft subtree. */
-static uint64_t perft_recursive(const Position* pos, int depth) {
+/* Copy-per-child perft variant kept as the baseline for make/unmake comparison. */
+static uint64_t perft_recursive_copy(const Position* pos, int depth) {
     MoveList legal;
     uint64_t nodes = 0ULL;
 
@@ -135,12 +256,231 @@ static uint64_t perft_recursive(const Position* pos, int depth) {
         if (!engine_apply_move(&next, legal.moves[i])) {
             continue;
         }
-        nodes += perft_recursive(&next, depth - 1);
+        nodes += perft_recursive_copy(&next, depth - 1);
     }
 
     return nodes;
 }
 
+/* Lock-free perft hash slot: check = key ^ data, so a torn write never verifies. */
+typedef struct PerftHashEntry {
+    _Atomic uint64_t check;
+    _Atomic uint64_t data;
+} PerftHashEntry;
+
+/* Shared subtree-count table keyed by (zobrist, depth); disabled when entries is NULL. */
+typedef struct PerftHash {
+    PerftHashEntry* entries;
+    uint64_t mask;
+} PerftHash;
+
+/* One perft subtree on the task scheduler; `nodes` is valid once its group has been waited. */
+typedef struct PerftTask {
+    Position pos;
+    int depth;
+    uint64_t nodes;
+} PerftTask;
+
+static PerftHash g_perft_hash = {NULL, 0ULL};
+/* The thread waiting on a perft helps run its tasks, so the scheduler has g_perft_threads - 1 workers. */
+static TaskScheduler* g_perft_scheduler = NULL;
+static int g_perft_threads = 1;
+static int g_perft_hash_mb = PERFT_DEFAULT_HASH_MB;
+
+/* Allocates the perft hash with the largest power-of-two entry count fitting size_mb. */
+static bool perft_hash_init(int size_mb) {
+    uint64_t bytes = (uint64_t)size_mb * 1024ULL * 1024ULL;
+    uint64_t count = 1ULL;
+
+    free(g_perft_hash.entries);
+    g_perft_hash.entries = NULL;
+    g_perft_hash.mask = 0ULL;
+    if (size_mb <= 0) {
+        return true;
+    }
+
+    while (count * 2ULL * sizeof(PerftHashEntry) <= bytes) {
+        count *= 2ULL;
+    }
+
+    g_perft_hash.entries = (PerftHashEntry*)calloc((size_t)count, sizeof(PerftHashEntry));
+    if (g_perft_hash.entries == NULL) {
+        return false;
+    }
+    g_perft_hash.mask = count - 1ULL;
+    return true;
+}
+
+static void perft_hash_free(void) {
+    free(g_perft_hash.entries);
+    g_perft_hash.entries = NULL;
+    g_perft_hash.mask = 0ULL;
+}
+
+static PerftHashEntry* perft_hash_slot(uint64_t key, int depth) {
+    return &g_perft_hash.entries[(key ^ ((uint64_t)depth * 0x9E3779B97F4A7C15ULL)) & g_perft_hash.mask];
+}
+
+static bool perft_hash_probe(uint64_t key, int depth, uint64_t* nodes) {
+    PerftHashEntry* entry = perft_hash_slot(key, depth);
+    uint64_t data = atomic_load_explicit(&entry->data, memory_order_relaxed);
+    uint64_t check = atomic_load_explicit(&entry->check, memory_order_relaxed);
+
+    if ((check ^ data) != key || (int)(data & 0xFFULL) != depth) {
+        return false;
+    }
+    *nodes = data >> 8;
+    return true;
+}
+
+static void perft_hash_store(uint64_t key, int depth, uint64_t nodes) {
+    PerftHashEntry* entry = perft_hash_slot(key, depth);
+    uint64_t data = (nodes << 8) | (uint64_t)(depth & 0xFF);
+
+    atomic_store_explicit(&entry->check, key ^ data, memory_order_relaxed);
+    atomic_store_explicit(&entry->data, data, memory_order_relaxed);
+}
+
+/* Bulk-counting perft that caches subtree counts in the shared hash near the root. */
+static uint64_t perft_hashed(Position* pos, int depth) {
+    PackedMoveList legal;
+    uint64_t nodes = 0ULL;
+
+    if (depth <= 0) {
+        return 1ULL;
+    }
+    if (depth >= PERFT_HASH_MIN_DEPTH && perft_hash_probe(pos->zobrist_key, depth, &nodes)) {
+        return nodes;
+    }
+
+    engine_generate_legal_packed(pos, &legal);
+    if (depth == 1) {
+        return (uint64_t)legal.count;
+    }
+
+    for (int i = 0; i < legal.count; ++i) {
+        MoveUndo undo;
+
+        if (!engine_make_packed(pos, legal.moves[i], &undo)) {
+            continue;
+        }
+        nodes += perft_hashed(pos, depth - 1);
+        engine_unmake_packed(pos, legal.moves[i], &undo);
+    }
+
+    if (depth >= PERFT_HASH_MIN_DEPTH) {
+        perft_hash_store(pos->zobrist_key, depth, nodes);
+    }
+    return nodes;
+}
+
+/* Serial subtree count, through the hash when it is enabled. */
+static uint64_t perft_serial(Position* pos, int depth) {
+    return (g_perft_hash.entries != NULL) ? perft_hashed(pos, depth) : perft_recursive(pos, depth);
+}
+
+static void perft_task(TaskScheduler* scheduler, void* arg);
+
+/*
+ * Spawns one perft_task per legal move of pos and waits for them, so idle workers steal
+ * whole subtrees at every level. Fills moves and, when non-NULL, counts per move; returns
+ * the total. Counts serially if the task storage cannot be allocated.
+ */
+static uint64_t perft_split(TaskScheduler* scheduler, const Position* pos, int depth, PackedMoveList* moves, uint64_t* counts) {
+    PerftTask* children;
+    Task* tasks;
+    TaskGroup group;
+    uint64_t total = 0ULL;
+
+    engine_generate_legal_packed(pos, moves);
+    if (moves->count == 0) {
+        return 0ULL;
+    }
+
+    children = (PerftTask*)malloc((size_t)moves->count * sizeof(*children));
+    tasks = (Task*)malloc((size_t)moves->count * sizeof(*tasks));
+    if (children == NULL || tasks == NULL) {
+        Position child = *pos;
+
+        free(children);
+        free(tasks);
+        for (int i = 0; i < moves->count; ++i) {
+            MoveUndo undo;
+            uint64_t nodes = 0ULL;
+
+            if (engine_make_packed(&child, moves->moves[i], &undo)) {
+                nodes = perft_serial(&child, depth - 1);
+                engine_unmake_packed(&child, moves->moves[i], &undo);
+            }
+            if (counts != NULL) {
+                counts[i] = nodes;
+            }
+            total += nodes;
+        }
+        return total;
+    }
+
+    task_group_init(&group);
+    for (int i = 0; i < moves->count; ++i) {
+        MoveUndo undo;
+
+        children[i].pos = *pos;
+        children[i].depth = depth - 1;
+        children[i].nodes = 0ULL;
+        if (engine_make_packed(&children[i].pos, moves->moves[i], &undo)) {
+            task_spawn(scheduler, &group, &tasks[i], perft_task, &children[i]);
+        }
+    }
+    task_group_wait(scheduler, &group);
+
+    for (int i = 0; i < moves->count; ++i) {
+        if (counts != NULL) {
+            counts[i] = children[i].nodes;
+        }
+        total += children[i].nodes;
+    }
+    free(children);
+    free(tasks);
+    return total;
+}
+
+static void perft_task(TaskScheduler* scheduler, void* arg) {
+    PerftTask* node = (PerftTask*)arg;
+    PackedMoveList moves;
+
+    if (node->depth <= PERFT_SERIAL_DEPTH) {
+        node->nodes = perft_serial(&node->pos, node->depth);
+        return;
+    }
+    if (g_perft_hash.entries != NULL && perft_hash_probe(node->pos.zobrist_key, node->depth, &node->nodes)) {
+        return;
+    }
+
+    node->nodes = perft_split(scheduler, &node->pos, node->depth, &moves, NULL);
+    if (g_perft_hash.entries != NULL) {
+        perft_hash_store(node->pos.zobrist_key, node->depth, node->nodes);
+    }
+}
+
+/*
+ * Parallel perft on g_perft_scheduler, split into subtree tasks down to
+ * PERFT_SERIAL_DEPTH. Fills moves/counts per root move and returns the total.
+ */
+static uint64_t perft_divide(const Position* root, int depth, PackedMoveList* moves, uint64_t counts[MAX_MOVES]) {
+    if (depth <= 0) {
+        moves->count = 0;
+        return 1ULL;
+    }
+    return perft_split(g_perft_scheduler, root, depth, moves, counts);
+}
+
+static uint64_t perft_parallel(const Position* root, int depth) {
+    PackedMoveList moves;
+    uint64_t counts[MAX_MOVES];
+
+    return perft_divide(root, depth, &moves, counts);
+}
+
 /* True when move appears in a space-separated expected list. */
 static bool move_in_expected_list(const char* expected_moves, const char* best_move) {
     const char* p;
@@ -179,15 +519,16 @@ static bool move_in_expected_list(const char* expected_moves, const char* best_m
     return false;
 }
 
-/* Runs one perft suite and returns number of failures. */
-static int run_perft_suite(bool quick_mode) {
-    const PerftCase* cases = quick_mode ? g_perft_cases_quick : g_perft_cases_full;
-    int case_count = quick_mode
-        ? (int)(sizeof(g_perft_cases_quick) / sizeof(g_perft_cases_quick[0]))
-        : (int)(sizeof(g_perft_cases_full) / sizeof(g_perft_cases_full[0]));
+/* Runs one perft suite (parallel, hashed) and returns number of failures. */
+static int run_perft_suite(const PerftCase* cases, int case_count, const char* label) {
     int failures = 0;
+    uint64_t total_nodes = 0ULL;
+    uint64_t total_ms = 0ULL;
 
-    printf("== Perft Suite (%s) ==\n", quick_mode ? "quick" : "full");
+    printf("== Perft Suite (%s) | threads=%d | hash=%dMB ==\n",
+           label,
+           g_perft_threads,
+           (g_perft_hash.entries != NULL) ? g_perft_hash_mb : 0);
 
     for (int i = 0; i < case_count; ++i) {
         Position pos;
@@ -201,9 +542,11 @@ static int run_perft_suite(bool quick_mode) {
             continue;
         }
 
-        start_ms = now_ms();
-        nodes = perft_recursive(&pos, cases[i].depth);
-        elapsed_ms = now_ms() - start_ms;
+        start_ms = engine_clock_ms();
+        nodes = perft_parallel(&pos, cases[i].depth);
+        elapsed_ms = engine_clock_ms() - start_ms;
+        total_nodes += nodes;
+        total_ms += elapsed_ms;
 
         if (nodes != cases[i].expected_nodes) {
             printf("[FAIL] %s | depth=%d | expected=%llu got=%llu | %llums\n",
@@ -214,12 +557,224 @@ static int run_perft_suite(bool quick_mode) {
                    (unsigned long long)elapsed_ms);
             failures++;
         } else {
-            printf("[ OK ] %s | depth=%d | nodes=%llu | %llums\n",
+            printf("[ OK ] %s | depth=%d | nodes=%llu | %llums | %llu nps\n",
                    cases[i].name,
                    cases[i].depth,
                    (unsigned long long)nodes,
-                   (unsigned long long)elapsed_ms);
+                   (unsigned long long)elapsed_ms,
+                   (unsigned long long)nodes_per_second(nodes, elapsed_ms));
+        }
+    }
+
+    printf("Perft total: nodes=%llu | %llums | %llu nps\n",
+           (unsigned long long)total_nodes,
+           (unsigned long long)total_ms,
+           (unsigned long long)nodes_per_second(total_nodes, total_ms));
+    printf("\n");
+    return failures;
+}
+
+/* Prints per-root-move subtree counts for one position (perft divide); returns failures. */
+static int run_perft_divide(const char* fen, int depth) {
+    Position pos;
+    PackedMoveList moves;
+    uint64_t counts[MAX_MOVES];
+    uint64_t start_ms;
+    uint64_t elapsed_ms;
+    uint64_t total;
+
+    if (!position_set_from_fen(&pos, fen)) {
+        printf("[FAIL] divide | invalid FEN\n");
+        return 1;
+    }
+
+    printf("== Perft Divide | depth=%d | threads=%d | hash=%dMB ==\n",
+           depth,
+           g_perft_threads,
+           (g_perft_hash.entries != NULL) ? g_perft_hash_mb : 0);
+
+    start_ms = engine_clock_ms();
+    total = perft_divide(&pos, depth, &moves, counts);
+    elapsed_ms = engine_clock_ms() - start_ms;
+
+    for (int i = 0; i < moves.count; ++i) {
+        char uci[6];
+
+        move_to_uci(engine_unpack_move(moves.moves[i]), uci);
+        printf("%s: %llu\n", uci, (unsigned long long)counts[i]);
+    }
+    printf("Moves: %d | nodes=%llu | %llums | %llu nps\n\n",
+           moves.count,
+           (unsigned long long)total,
+           (unsigned long long)elapsed_ms,
+           (unsigned long long)nodes_per_second(total, elapsed_ms));
+    return 0;
+}
+
+/* Times make/unmake against copy-make on the same perft trees; returns failures. */
+static int run_make_unmake_comparison(bool quick_mode) {
+    const PerftCase* cases = quick_mode ? g_perft_cases_quick : g_perft_cases_full;
+    int case_count = 2;
+    int failures = 0;
+
+    printf("== Make/Unmake vs Copy ==\n");
+
+    for (int i = 0; i < case_count; ++i) {
+        Position pos;
+        uint64_t start_ms;
+        uint64_t unmake_ms;
+        uint64_t copy_ms;
+        uint64_t unmake_nodes;
+        uint64_t copy_nodes;
+
+        if (!position_set_from_fen(&pos, cases[i].fen)) {
+            printf("[FAIL] %s | invalid FEN\n", cases[i].name);
+            failures++;
+            continue;
+        }
+
+        start_ms = engine_clock_ms();
+        unmake_nodes = perft_recursive(&pos, cases[i].depth);
+        unmake_ms = engine_clock_ms() - start_ms;
+
+        start_ms = engine_clock_ms();
+        copy_nodes = perft_recursive_copy(&pos, cases[i].depth);
+        copy_ms = engine_clock_ms() - start_ms;
+
+        if (unmake_nodes != cases[i].expected_nodes || copy_nodes != cases[i].expected_nodes) {
+            printf("[FAIL] %s | unmake=%llu copy=%llu expected=%llu\n",
+                   cases[i].name,
+                   (unsigned long long)unmake_nodes,
+                   (unsigned long long)copy_nodes,
+                   (unsigned long long)cases[i].expected_nodes);
+            failures++;
+            continue;
         }
+
+        printf("[ OK ] %s | unmake=%llums (%llu nps) | copy=%llums (%llu nps)\n",
+               cases[i].name,
+               (unsigned long long)unmake_ms,
+               (unsigned long long)nodes_per_second(unmake_nodes, unmake_ms),
+               (unsigned long long)copy_ms,
+               (unsigned long long)nodes_per_second(copy_nodes, copy_ms));
+    }
+
+    printf("\n");
+    return failures;
+}
+
+/* True when the move appears in the list with identical flags and promotion. */
+static bool move_list_contains(const MoveList* list, Move move) {
+    for (int i = 0; i < list->count; ++i) {
+        const Move* m = &list->moves[i];
+        if (m->from == move.from && m->to == move.to && m->flags == move.flags && m->promotion == move.promotion) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Checks captures/evasions generators against the full legal list at one node. */
+static bool staged_generators_match(const Position* pos) {
+    MoveList legal;
+    MoveList captures;
+    MoveList evasions;
+    int expected_captures = 0;
+
+    generate_legal_moves(pos, &legal);
+    generate_captures(pos, &captures);
+    generate_evasions(pos, &evasions);
+
+    for (int i = 0; i < legal.count; ++i) {
+        Move move = legal.moves[i];
+        bool wanted = (move.flags & MOVE_FLAG_CAPTURE) != 0U ||
+                      ((move.flags & MOVE_FLAG_PROMOTION) != 0U && move.promotion == PIECE_QUEEN);
+
+        if ((move.flags & MOVE_FLAG_PROMOTION) != 0U && move.promotion != PIECE_QUEEN) {
+            wanted = false;
+        }
+        if (wanted) {
+            expected_captures++;
+            if (!move_list_contains(&captures, move)) {
+                return false;
+            }
+        }
+    }
+    if (captures.count != expected_captures) {
+        return false;
+    }
+
+    if (engine_in_check(pos, pos->side_to_move)) {
+        if (evasions.count != legal.count) {
+            return false;
+        }
+        for (int i = 0; i < evasions.count; ++i) {
+            if (!move_list_contains(&legal, evasions.moves[i])) {
+                return false;
+            }
+        }
+    } else if (evasions.count != 0) {
+        return false;
+    }
+
+    return true;
+}
+
+/* Walks the perft tree comparing staged generators at every node; returns mismatching nodes. */
+static uint64_t staged_generator_walk(Position* pos, int depth, uint64_t* nodes) {
+    MoveList legal;
+    uint64_t mismatches = staged_generators_match(pos) ? 0ULL : 1ULL;
+
+    (*nodes)++;
+    if (depth <= 0) {
+        return mismatches;
+    }
+
+    generate_legal_moves(pos, &legal);
+    for (int i = 0; i < legal.count; ++i) {
+        MoveUndo undo;
+
+        if (!engine_make_move_fast(pos, legal.moves[i], &undo)) {
+            continue;
+        }
+        mismatches += staged_generator_walk(pos, depth - 1, nodes);
+        engine_unmake_move(pos, legal.moves[i], &undo);
+    }
+    return mismatches;
+}
+
+/* Validates generate_captures/generate_evasions over every perft position tree. */
+static int run_staged_generator_check(bool quick_mode) {
+    const PerftCase* cases = quick_mode ? g_perft_cases_quick : g_perft_cases_full;
+    int case_count = quick_mode ? (int)(sizeof(g_perft_cases_quick) / sizeof(g_perft_cases_quick[0]))
+                                : (int)(sizeof(g_perft_cases_full) / sizeof(g_perft_cases_full[0]));
+    int walk_depth = quick_mode ? 2 : 3;
+    int failures = 0;
+
+    printf("== Captures/Evasions Generators ==\n");
+
+    for (int i = 0; i < case_count; ++i) {
+        Position pos;
+        uint64_t nodes = 0ULL;
+        uint64_t mismatches;
+
+        if (!position_set_from_fen(&pos, cases[i].fen)) {
+            printf("[FAIL] %s | invalid FEN\n", cases[i].name);
+            failures++;
+            continue;
+        }
+
+        mismatches = staged_generator_walk(&pos, walk_depth, &nodes);
+        if (mismatches != 0ULL) {
+            printf("[FAIL] %s | %llu of %llu nodes mismatch\n",
+                   cases[i].name,
+                   (unsigned long long)mismatches,
+                   (unsigned long long)nodes);
+            failures++;
+            continue;
+        }
+
+        printf("[ OK ] %s | nodes=%llu\n", cases[i].name, (unsigned long long)nodes);
     }
 
     printf("\n");
@@ -247,13 +802,15 @@ static int run_tactical_suite(void) {
             continue;
         }
 
+        memset(&limits, 0, sizeof(limits));
         limits.depth = g_tactical_cases[i].depth;
         limits.max_time_ms = g_tactical_cases[i].max_time_ms;
         limits.randomness = 0;
+        limits.threads = 1;
 
-        start_ms = now_ms();
+        start_ms = engine_clock_ms();
         search_best_move(&pos, &limits, &result);
-        elapsed_ms = now_ms() - start_ms;
+        elapsed_ms = engine_clock_ms() - start_ms;
 
         move_to_uci(result.best_move, best_uci);
 
@@ -268,13 +825,862 @@ static int run_tactical_suite(void) {
                    (unsigned long long)elapsed_ms);
             failures++;
         } else {
-            printf("[ OK ] %s | best=%s | depth=%d nodes=%llu score=%d | %llums\n",
+            printf("[ OK ] %s | best=%s | depth=%d nodes=%llu qnodes=%llu score=%d | %llums | %llu nps\n",
                    g_tactical_cases[i].name,
                    best_uci,
                    result.depth_reached,
                    (unsigned long long)result.nodes,
+                   (unsigned long long)result.qsearch_nodes,
                    result.score,
-                   (unsigned long long)elapsed_ms);
+                   (unsigned long long)elapsed_ms,
+                   (unsigned long long)nodes_per_second(result.nodes, elapsed_ms));
+        }
+    }
+
+    printf("\n");
+    return failures;
+}
+
+/* Runs fixed-depth searches from a cleared TT and reports time-to-depth; returns failures. */
+static int run_search_speed_suite(bool quick) {
+    int case_count = (int)(sizeof(g_search_speed_cases) / sizeof(g_search_speed_cases[0]));
+    int failures = 0;
+    uint64_t total_nodes = 0;
+    uint64_t total_qnodes = 0;
+    uint64_t total_ms = 0;
+    uint64_t pawn_probes = 0;
+    uint64_t pawn_hits = 0;
+    uint64_t eval_probes = 0;
+    uint64_t eval_hits = 0;
+
+    printf("== Search Speed (%s) | tt=%dMB ==\n", quick ? "quick" : "full", engine_get_hash_size());
+
+    for (int i = 0; i < case_count; ++i) {
+        const SearchSpeedCase* test_case = &g_search_speed_cases[i];
+        Position pos;
+        SearchLimits limits;
+        SearchResult result;
+        uint64_t start_ms;
+        uint64_t elapsed_ms;
+
+        if (!position_set_from_fen(&pos, test_case->fen)) {
+            printf("[FAIL] %s | invalid FEN\n", test_case->name);
+            failures++;
+            continue;
+        }
+
+        memset(&limits, 0, sizeof(limits));
+        limits.depth = quick ? test_case->quick_depth : test_case->depth;
+        limits.max_time_ms = 120000;
+        limits.randomness = 0;
+        limits.threads = 1;
+
+        engine_reset_transposition_table();
+        start_ms = engine_clock_ms();
+        search_best_move(&pos, &limits, &result);
+        elapsed_ms = engine_clock_ms() - start_ms;
+        total_nodes += result.nodes;
+        total_qnodes += result.qsearch_nodes;
+        total_ms += elapsed_ms;
+        pawn_probes += result.pawn_hash_probes;
+        pawn_hits += result.pawn_hash_hits;
+        eval_probes += result.eval_cache_probes;
+        eval_hits += result.eval_cache_hits;
+
+        if (result.depth_reached != limits.depth) {
+            printf("[FAIL] %s | reached depth %d of %d\n", test_case->name, result.depth_reached, limits.depth);
+            failures++;
+            continue;
+        }
+
+        printf("[ OK ] %s | depth=%d | nodes=%llu qnodes=%llu | %llums | %llu nps | pawn hash %llu.%llu%% | eval cache %llu.%llu%%\n",
+               test_case->name,
+               result.depth_reached,
+               (unsigned long long)result.nodes,
+               (unsigned long long)result.qsearch_nodes,
+               (unsigned long long)elapsed_ms,
+               (unsigned long long)nodes_per_second(result.nodes, elapsed_ms),
+               (unsigned long long)(per_mille(result.pawn_hash_hits, result.pawn_hash_probes) / 10ULL),
+               (unsigned long long)(per_mille(result.pawn_hash_hits, result.pawn_hash_probes) % 10ULL),
+               (unsigned long long)(per_mille(result.eval_cache_hits, result.eval_cache_probes) / 10ULL),
+               (unsigned long long)(per_mille(result.eval_cache_hits, result.eval_cache_probes) % 10ULL));
+    }
+
+    printf("Search total: nodes=%llu qnodes=%llu | %llums | %llu nps\n",
+           (unsigned long long)total_nodes,
+           (unsigned long long)total_qnodes,
+           (unsigned long long)total_ms,
+           (unsigned long long)nodes_per_second(total_nodes, total_ms));
+    printf("Eval caches: pawn hash %llu.%llu%% of %llu probes | eval cache %llu.%llu%% of %llu probes\n\n",
+           (unsigned long long)(per_mille(pawn_hits, pawn_probes) / 10ULL),
+           (unsigned long long)(per_mille(pawn_hits, pawn_probes) % 10ULL),
+           (unsigned long long)pawn_probes,
+           (unsigned long long)(per_mille(eval_hits, eval_probes) / 10ULL),
+           (unsigned long long)(per_mille(eval_hits, eval_probes) % 10ULL),
+           (unsigned long long)eval_probes);
+    engine_reset_transposition_table();
+    return failures;
+}
+
+/* Clock inputs for the time-manager check; `budget_ms` is the most a move may take. */
+typedef struct TimeControlCase {
+    const char* name;
+    int max_time_ms;
+    int time_left_ms;
+    int increment_ms;
+    int moves_to_go;
+    int budget_ms;
+} TimeControlCase;
+
+static const TimeControlCase g_time_control_cases[] = {
+    {"Move time 100ms", 100, 0, 0, 0, 100},
+    {"Move time 400ms", 400, 0, 0, 0, 400},
+    {"Clock 10s sudden death", 0, 10000, 0, 0, 8000},
+    {"Clock 3s + 200ms", 0, 3000, 200, 0, 2400},
+    {"Clock 1s, 1 move to go", 0, 1000, 0, 1, 800}
+};
+
+/*
+ * Searches the middlegame speed case under several time controls and checks that no move
+ * overruns its hard budget; reports the time actually used and the depth it bought.
+ */
+static int run_time_manager_check(bool quick) {
+    int case_count = quick ? 1 : (int)(sizeof(g_time_control_cases) / sizeof(g_time_control_cases[0]));
+    int failures = 0;
+    Position pos;
+
+    printf("== Time Manager ==\n");
+    if (!position_set_from_fen(&pos, g_search_speed_cases[1].fen)) {
+        printf("[FAIL] invalid FEN\n\n");
+        return 1;
+    }
+
+    for (int i = 0; i < case_count; ++i) {
+        const TimeControlCase* test_case = &g_time_control_cases[i];
+        SearchLimits limits;
+        SearchResult result;
+        uint64_t start_ms;
+        uint64_t elapsed_ms;
+
+        memset(&limits, 0, sizeof(limits));
+        limits.depth = 64;
+        limits.max_time_ms = test_case->max_time_ms;
+        limits.threads = 1;
+        limits.time_left_ms = test_case->time_left_ms;
+        limits.increment_ms = test_case->increment_ms;
+        limits.moves_to_go = test_case->moves_to_go;
+
+        engine_reset_transposition_table();
+        start_ms = engine_clock_ms();
+        search_best_move(&pos, &limits, &result);
+        elapsed_ms = engine_clock_ms() - start_ms;
+
+        /* A little slack for the 1024-node polling interval and scheduler noise. */
+        if (elapsed_ms > (uint64_t)test_case->budget_ms + 50ULL || result.depth_reached < 1) {
+            printf("[FAIL] %s | used %llums of %dms | depth=%d\n",
+                   test_case->name,
+                   (unsigned long long)elapsed_ms,
+                   test_case->budget_ms,
+                   result.depth_reached);
+            failures++;
+            continue;
+        }
+        printf("[ OK ] %s | used %llums of %dms | depth=%d nodes=%llu\n",
+               test_case->name,
+               (unsigned long long)elapsed_ms,
+               test_case->budget_ms,
+               result.depth_reached,
+               (unsigned long long)result.nodes);
+    }
+
+    printf("\n");
+    engine_reset_transposition_table();
+    return failures;
+}
+
+static const uint64_t g_node_budgets[] = {2000ULL, 50000ULL, 400000ULL};
+
+/*
+ * Searches the middlegame speed case twice per node budget with no time limit and checks
+ * that the budget is never exceeded and that both runs agree on move, depth and node count.
+ */
+static int run_node_limit_check(bool quick) {
+    int case_count = quick ? 2 : (int)(sizeof(g_node_budgets) / sizeof(g_node_budgets[0]));
+    int failures = 0;
+    Position pos;
+
+    printf("== Node Limit ==\n");
+    if (!position_set_from_fen(&pos, g_search_speed_cases[1].fen)) {
+        printf("[FAIL] invalid FEN\n\n");
+        return 1;
+    }
+
+    for (int i = 0; i < case_count; ++i) {
+        SearchLimits limits;
+        SearchResult first;
+        SearchResult second;
+        char first_uci[6];
+        char second_uci[6];
+        uint64_t start_ms;
+        uint64_t elapsed_ms;
+
+        memset(&limits, 0, sizeof(limits));
+        limits.depth = 64;
+        limits.threads = 1;
+        limits.max_nodes = g_node_budgets[i];
+
+        engine_reset_transposition_table();
+        start_ms = engine_clock_ms();
+        search_best_move(&pos, &limits, &first);
+        elapsed_ms = engine_clock_ms() - start_ms;
+        engine_reset_transposition_table();
+        search_best_move(&pos, &limits, &second);
+
+        move_to_uci(first.best_move, first_uci);
+        move_to_uci(second.best_move, second_uci);
+        if (first.nodes > limits.max_nodes || first.depth_reached < 1 || first.nodes != second.nodes ||
+            first.depth_reached != second.depth_reached || strcmp(first_uci, second_uci) != 0) {
+            printf("[FAIL] budget %llu | runs: %s/%s depth=%d/%d nodes=%llu/%llu\n",
+                   (unsigned long long)limits.max_nodes,
+                   first_uci,
+                   second_uci,
+                   first.depth_reached,
+                   second.depth_reached,
+                   (unsigned long long)first.nodes,
+                   (unsigned long long)second.nodes);
+            failures++;
+            continue;
+        }
+        printf("[ OK ] budget %llu | best=%s depth=%d nodes=%llu | %llums\n",
+               (unsigned long long)limits.max_nodes,
+               first_uci,
+               first.depth_reached,
+               (unsigned long long)first.nodes,
+               (unsigned long long)elapsed_ms);
+    }
+
+    printf("\n");
+    engine_reset_transposition_table();
+    return failures;
+}
+
+#define POOL_TASK_COUNT 2000
+#define POOL_NESTED_CHILDREN 8
+#define POOL_LATENCY_ROUNDS 20000
+
+static void* pool_count_task(void* arg) {
+    atomic_fetch_add((atomic_int*)arg, 1);
+    return arg;
+}
+
+static void* pool_empty_task(void* arg) {
+    return arg;
+}
+
+/* Submits children to the pool it runs on and waits for them. */
+static void* pool_nested_task(void* arg) {
+    ChessThreadPool* pool = (ChessThreadPool*)arg;
+    ChessFuture* children[POOL_NESTED_CHILDREN];
+    atomic_int counter;
+    intptr_t finished = 0;
+
+    atomic_init(&counter, 0);
+    for (int i = 0; i < POOL_NESTED_CHILDREN; ++i) {
+        children[i] = chess_pool_submit(pool, pool_count_task, &counter);
+    }
+    for (int i = 0; i < POOL_NESTED_CHILDREN; ++i) {
+        finished += (chess_future_wait(children[i]) == &counter) ? 1 : 0;
+    }
+    return (void*)(finished + (intptr_t)atomic_load(&counter));
+}
+
+/*
+ * Checks that every pool task runs once and returns its value through the future, that a task
+ * can wait on its own subtasks in a one-thread pool, and compares submit+wait latency with
+ * creating and joining a thread per task.
+ */
+static int run_thread_pool_check(void) {
+    ChessThreadPool* pool = chess_pool_shared();
+    ChessThreadPool* single = chess_pool_create(1, false);
+    ChessFuture* futures[POOL_TASK_COUNT];
+    atomic_int counter;
+    int returned = 0;
+    intptr_t nested;
+    uint64_t start_ms;
+    uint64_t pool_ms;
+    uint64_t thread_ms;
+    int failures = 0;
+
+    printf("== Thread Pool ==\n");
+    if (pool == NULL || single == NULL) {
+        printf("[FAIL] pool creation\n\n");
+        chess_pool_destroy(single);
+        return 1;
+    }
+
+    atomic_init(&counter, 0);
+    for (int i = 0; i < POOL_TASK_COUNT; ++i) {
+        futures[i] = chess_pool_submit(pool, pool_count_task, &counter);
+    }
+    for (int i = 0; i < POOL_TASK_COUNT; ++i) {
+        returned += (chess_future_wait(futures[i]) == &counter) ? 1 : 0;
+    }
+    if (atomic_load(&counter) != POOL_TASK_COUNT || returned != POOL_TASK_COUNT) {
+        printf("[FAIL] Tasks | ran %d returned %d of %d\n", atomic_load(&counter), returned, POOL_TASK_COUNT);
+        failures++;
+    } else {
+        printf("[ OK ] Tasks | %d run once each on %d workers\n", POOL_TASK_COUNT, chess_pool_size(pool));
+    }
+
+    nested = (intptr_t)chess_future_wait(chess_pool_submit(single, pool_nested_task, single));
+    if (nested != 2 * POOL_NESTED_CHILDREN) {
+        printf("[FAIL] Nested wait | %d of %d children\n", (int)(nested / 2), POOL_NESTED_CHILDREN);
+        failures++;
+    } else {
+        printf("[ OK ] Nested wait | %d children on a 1-thread pool\n", POOL_NESTED_CHILDREN);
+    }
+    chess_pool_destroy(single);
+
+    start_ms = engine_clock_ms();
+    for (int i = 0; i < POOL_LATENCY_ROUNDS; ++i) {
+        (void)chess_future_wait(chess_pool_submit(pool, pool_empty_task, NULL));
+    }
+    pool_ms = engine_clock_ms() - start_ms;
+    start_ms = engine_clock_ms();
+    for (int i = 0; i < POOL_LATENCY_ROUNDS; ++i) {
+        ChessThread thread = {NULL, false};
+
+        if (chess_thread_create(&thread, pool_empty_task, NULL)) {
+            chess_thread_join(&thread);
+        }
+    }
+    thread_ms = engine_clock_ms() - start_ms;
+    printf("Round trip x%d: pool %llums | thread create/join %llums\n\n",
+           POOL_LATENCY_ROUNDS,
+           (unsigned long long)pool_ms,
+           (unsigned long long)thread_ms);
+    return failures;
+}
+
+#define INSTANCE_CASE_COUNT ((int)(sizeof(g_search_speed_cases) / sizeof(g_search_speed_cases[0])))
+#define INSTANCE_HASH_MB 8
+
+/* One engine instance searching one speed case as its own pool task. */
+typedef struct InstanceJob {
+    Engine* engine;
+    Position pos;
+    SearchLimits limits;
+    SearchResult result;
+    ChessFuture* future;
+} InstanceJob;
+
+static void* instance_job_main(void* arg) {
+    InstanceJob* job = (InstanceJob*)arg;
+
+    engine_search(job->engine, &job->pos, &job->limits, &job->result);
+    return NULL;
+}
+
+/*
+ * Searches every speed case on its own Engine instance, first one after another and then
+ * all at once as pool tasks; since instances share no mutable state, each concurrent
+ * result must match its sequential one node for node.
+ */
+static int run_engine_instance_check(bool quick) {
+    InstanceJob jobs[INSTANCE_CASE_COUNT];
+    SearchResult sequential[INSTANCE_CASE_COUNT];
+    uint64_t sequential_ms;
+    uint64_t concurrent_ms;
+    uint64_t start_ms;
+    int failures = 0;
+
+    printf("== Engine Instances ==\n");
+    memset(jobs, 0, sizeof(jobs));
+    for (int i = 0; i < INSTANCE_CASE_COUNT; ++i) {
+        const SearchSpeedCase* test_case = &g_search_speed_cases[i];
+
+        jobs[i].engine = engine_create(INSTANCE_HASH_MB);
+        if (jobs[i].engine == NULL || !position_set_from_fen(&jobs[i].pos, test_case->fen)) {
+            printf("[FAIL] %s | setup\n\n", test_case->name);
+            for (int j = 0; j <= i; ++j) {
+                engine_destroy(jobs[j].engine);
+            }
+            return 1;
+        }
+        jobs[i].limits.depth = quick ? test_case->quick_depth : test_case->depth;
+        jobs[i].limits.threads = 1;
+    }
+
+    start_ms = engine_clock_ms();
+    for (int i = 0; i < INSTANCE_CASE_COUNT; ++i) {
+        engine_clear(jobs[i].engine);
+        engine_search(jobs[i].engine, &jobs[i].pos, &jobs[i].limits, &sequential[i]);
+    }
+    sequential_ms = engine_clock_ms() - start_ms;
+
+    start_ms = engine_clock_ms();
+    for (int i = 0; i < INSTANCE_CASE_COUNT; ++i) {
+        engine_clear(jobs[i].engine);
+        jobs[i].future = chess_pool_submit(chess_pool_shared(), instance_job_main, &jobs[i]);
+        if (jobs[i].future == NULL) {
+            instance_job_main(&jobs[i]);
+        }
+    }
+    for (int i = 0; i < INSTANCE_CASE_COUNT; ++i) {
+        (void)chess_future_wait(jobs[i].future);
+    }
+    concurrent_ms = engine_clock_ms() - start_ms;
+
+    for (int i = 0; i < INSTANCE_CASE_COUNT; ++i) {
+        char sequential_uci[6];
+        char concurrent_uci[6];
+
+        move_to_uci(sequential[i].best_move, sequential_uci);
+        move_to_uci(jobs[i].result.best_move, concurrent_uci);
+        if (sequential[i].nodes != jobs[i].result.nodes || strcmp(sequential_uci, concurrent_uci) != 0) {
+            printf("[FAIL] %s | sequential %s nodes=%llu | concurrent %s nodes=%llu\n",
+                   g_search_speed_cases[i].name,
+                   sequential_uci,
+                   (unsigned long long)sequential[i].nodes,
+                   concurrent_uci,
+                   (unsigned long long)jobs[i].result.nodes);
+            failures++;
+        } else {
+            printf("[ OK ] %s | best=%s nodes=%llu\n",
+                   g_search_speed_cases[i].name,
+                   concurrent_uci,
+                   (unsigned long long)jobs[i].result.nodes);
+        }
+        engine_destroy(jobs[i].engine);
+    }
+    printf("%d instances: sequential %llums | concurrent %llums\n\n",
+           INSTANCE_CASE_COUNT,
+           (unsigned long long)sequential_ms,
+           (unsigned long long)concurrent_ms);
+    return failures;
+}
+
+/*
+ * Starts an unbounded background search, cancels it mid-flight and checks that the handle
+ * returns promptly with a legal move and can immediately run the next search; then ponders
+ * past the time limit and checks that a ponder hit ends it on the spent budget. Returns failures.
+ */
+static int run_search_handle_check(void) {
+    SearchHandle* handle = search_handle_create();
+    SearchLimits limits;
+    SearchResult result;
+    Position pos;
+    uint64_t stop_ms;
+    uint64_t latency_ms;
+    int failures = 0;
+
+    printf("== Search Handle ==\n");
+    if (handle == NULL || !position_set_from_fen(&pos, g_search_speed_cases[0].fen)) {
+        printf("[FAIL] setup\n\n");
+        search_handle_destroy(handle);
+        return 1;
+    }
+
+    memset(&limits, 0, sizeof(limits));
+    limits.depth = 64;
+    limits.max_time_ms = 0;
+    limits.randomness = 0;
+    limits.threads = 2;
+    if (!search_start(handle, &pos, &limits)) {
+        printf("[FAIL] search_start\n\n");
+        search_handle_destroy(handle);
+        return 1;
+    }
+
+    chess_sleep_ms(50);
+    stop_ms = engine_clock_ms();
+    search_stop(handle);
+    if (!search_wait(handle, &result)) {
+        printf("[FAIL] search_wait found no search\n\n");
+        search_handle_destroy(handle);
+        return 1;
+    }
+    latency_ms = engine_clock_ms() - stop_ms;
+
+    if (!engine_is_move_legal(&pos, result.best_move) || latency_ms > 100ULL) {
+        printf("[FAIL] Cancel | legal=%d | stop latency %llums\n",
+               engine_is_move_legal(&pos, result.best_move) ? 1 : 0,
+               (unsigned long long)latency_ms);
+        failures++;
+    } else {
+        printf("[ OK ] Cancel | depth=%d nodes=%llu | stop latency %llums\n",
+               result.depth_reached,
+               (unsigned long long)result.nodes,
+               (unsigned long long)latency_ms);
+    }
+
+    limits.depth = 4;
+    limits.threads = 1;
+    if (!search_start(handle, &pos, &limits) || !search_wait(handle, &result) || result.depth_reached != 4 ||
+        !result.has_ponder_move) {
+        printf("[FAIL] Restart after cancel | depth=%d ponder move=%d\n",
+               result.depth_reached,
+               result.has_ponder_move ? 1 : 0);
+        failures++;
+    } else {
+        printf("[ OK ] Restart after cancel | depth=%d nodes=%llu\n",
+               result.depth_reached,
+               (unsigned long long)result.nodes);
+    }
+
+    limits.depth = 64;
+    limits.max_time_ms = 40;
+    if (!search_start_ponder(handle, &pos, &limits)) {
+        printf("[FAIL] search_start_ponder\n\n");
+        search_handle_destroy(handle);
+        return failures + 1;
+    }
+    chess_sleep_ms(120);
+    {
+        bool ponder_alive = search_is_running(handle);
+
+        stop_ms = engine_clock_ms();
+        search_ponderhit(handle);
+        (void)search_wait(handle, &result);
+        latency_ms = engine_clock_ms() - stop_ms;
+        if (!ponder_alive || latency_ms > 100ULL || !engine_is_move_legal(&pos, result.best_move)) {
+            printf("[FAIL] Ponder | outlived time limit=%d | hit latency %llums\n",
+                   ponder_alive ? 1 : 0,
+                   (unsigned long long)latency_ms);
+            failures++;
+        } else {
+            printf("[ OK ] Ponder | depth=%d nodes=%llu | hit latency %llums\n",
+                   result.depth_reached,
+                   (unsigned long long)result.nodes,
+                   (unsigned long long)latency_ms);
+        }
+    }
+
+    printf("\n");
+    search_handle_destroy(handle);
+    return failures;
+}
+
+/* Lazy SMP scaling: total time-to-depth and nps over the search-speed cases per thread count. */
+static int run_thread_scaling_suite(bool quick) {
+    static const int thread_counts[] = {1, 2, 4, 8, 16};
+    int case_count = (int)(sizeof(g_search_speed_cases) / sizeof(g_search_speed_cases[0]));
+    int failures = 0;
+    uint64_t baseline_ms = 0ULL;
+    int pool_size = chess_pool_size(chess_pool_shared());
+
+    printf("== Thread Scaling (%s) | cpus=%d | pool=%d | tt=%dMB ==\n",
+           quick ? "quick" : "full",
+           chess_cpu_count(),
+           pool_size,
+           engine_get_hash_size());
+
+    for (int t = 0; t < (int)(sizeof(thread_counts) / sizeof(thread_counts[0])); ++t) {
+        uint64_t total_nodes = 0ULL;
+        uint64_t total_ms = 0ULL;
+        uint64_t speedup_x100;
+        int min_helpers = thread_counts[t] - 1;
+        bool ok = true;
+
+        /* Helpers only start on idle pool workers, so such a row would measure fewer threads. */
+        if (thread_counts[t] - 1 > pool_size) {
+            printf("[SKIP] threads=%-2d | needs %d helpers, shared pool has %d workers\n",
+                   thread_counts[t],
+                   thread_counts[t] - 1,
+                   pool_size);
+            continue;
+        }
+
+        for (int i = 0; i < case_count; ++i) {
+            const SearchSpeedCase* test_case = &g_search_speed_cases[i];
+            Position pos;
+            SearchLimits limits;
+            SearchResult result;
+            uint64_t start_ms;
+
+            if (!position_set_from_fen(&pos, test_case->fen)) {
+                ok = false;
+                continue;
+            }
+
+            memset(&limits, 0, sizeof(limits));
+            limits.depth = quick ? test_case->quick_depth : test_case->depth;
+            limits.max_time_ms = 120000;
+            limits.randomness = 0;
+            limits.threads = thread_counts[t];
+
+            engine_reset_transposition_table();
+            start_ms = engine_clock_ms();
+            search_best_move(&pos, &limits, &result);
+            total_ms += engine_clock_ms() - start_ms;
+            total_nodes += result.nodes;
+            if (result.helper_threads < min_helpers) {
+                min_helpers = result.helper_threads;
+            }
+
+            if (result.depth_reached < limits.depth || !engine_is_move_legal(&pos, result.best_move)) {
+                printf("[FAIL] threads=%d | %s | depth %d of %d\n",
+                       thread_counts[t],
+                       test_case->name,
+                       result.depth_reached,
+                       limits.depth);
+                ok = false;
+            }
+        }
+
+        if (t == 0) {
+            baseline_ms = total_ms;
+        }
+        speedup_x100 = (baseline_ms * 100ULL) / (total_ms > 0ULL ? total_ms : 1ULL);
+        if (!ok) {
+            failures++;
+        }
+
+        printf("[%s] threads=%-2d | helpers=%d | time-to-depth=%llums | speedup=%llu.%02llux | nodes=%llu | %llu nps\n",
+               ok ? " OK " : "FAIL",
+               thread_counts[t],
+               min_helpers,
+               (unsigned long long)total_ms,
+               (unsigned long long)(speedup_x100 / 100ULL),
+               (unsigned long long)(speedup_x100 % 100ULL),
+               (unsigned long long)total_nodes,
+               (unsigned long long)nodes_per_second(total_nodes, total_ms));
+    }
+
+    printf("\n");
+    engine_reset_transposition_table();
+    return failures;
+}
+
+/* Times TT allocation, clearing and fixed-depth search at several table sizes; returns failures. */
+static int run_tt_memory_report(bool quick) {
+    static const int sizes_full[] = {32, 256, 1024};
+    static const int sizes_quick[] = {16, 64};
+    const int* sizes = quick ? sizes_quick : sizes_full;
+    int size_count = quick ? (int)(sizeof(sizes_quick) / sizeof(sizes_quick[0]))
+                           : (int)(sizeof(sizes_full) / sizeof(sizes_full[0]));
+    int case_count = (int)(sizeof(g_search_speed_cases) / sizeof(g_search_speed_cases[0]));
+    int restore_mb = engine_get_hash_size();
+    int failures = 0;
+
+    printf("== TT Memory (%s) | cpus=%d ==\n", quick ? "quick" : "full", chess_cpu_count());
+
+    for (int s = 0; s < size_count; ++s) {
+        uint64_t start_ms;
+        uint64_t alloc_ms;
+        uint64_t clear_ms;
+        uint64_t search_ms = 0ULL;
+        uint64_t search_nodes = 0ULL;
+
+        start_ms = engine_clock_ms();
+        if (!engine_set_hash_size(sizes[s])) {
+            printf("[FAIL] tt=%dMB | allocation failed\n", sizes[s]);
+            failures++;
+            continue;
+        }
+        alloc_ms = engine_clock_ms() - start_ms;
+
+        start_ms = engine_clock_ms();
+        engine_reset_transposition_table();
+        clear_ms = engine_clock_ms() - start_ms;
+
+        for (int i = 0; i < case_count; ++i) {
+            const SearchSpeedCase* test_case = &g_search_speed_cases[i];
+            Position pos;
+            SearchLimits limits;
+            SearchResult result;
+
+            if (!position_set_from_fen(&pos, test_case->fen)) {
+                failures++;
+                continue;
+            }
+
+            memset(&limits, 0, sizeof(limits));
+            limits.depth = quick ? test_case->quick_depth : test_case->depth;
+            limits.max_time_ms = 120000;
+            limits.randomness = 0;
+            limits.threads = 1;
+
+            engine_reset_transposition_table();
+            start_ms = engine_clock_ms();
+            search_best_move(&pos, &limits, &result);
+            search_ms += engine_clock_ms() - start_ms;
+            search_nodes += result.nodes;
+        }
+
+        printf("[ OK ] tt=%dMB | %s | alloc+touch=%llums | clear=%llums | search=%llums | %llu nps\n",
+               sizes[s],
+               engine_hash_uses_huge_pages() ? "huge pages" : "malloc",
+               (unsigned long long)alloc_ms,
+               (unsigned long long)clear_ms,
+               (unsigned long long)search_ms,
+               (unsigned long long)nodes_per_second(search_nodes, search_ms));
+    }
+
+    printf("\n");
+    (void)engine_set_hash_size(restore_mb);
+    return failures;
+}
+
+#define SCHED_TREE_DEPTH_QUICK 16
+#define SCHED_TREE_DEPTH_FULL 20
+#define SCHED_BURST_QUICK 20000
+#define SCHED_BURST_FULL 200000
+
+/* One node of the binary spawn tree; `leaves` is filled in by the task. */
+typedef struct SchedTreeNode {
+    int depth;
+    uint64_t leaves;
+} SchedTreeNode;
+
+static void sched_tree_task(TaskScheduler* scheduler, void* arg) {
+    SchedTreeNode* node = (SchedTreeNode*)arg;
+    SchedTreeNode children[2];
+    Task tasks[2];
+    TaskGroup group;
+
+    if (node->depth <= 0) {
+        node->leaves = 1ULL;
+        return;
+    }
+
+    task_group_init(&group);
+    for (int i = 0; i < 2; ++i) {
+        children[i].depth = node->depth - 1;
+        children[i].leaves = 0ULL;
+        task_spawn(scheduler, &group, &tasks[i], sched_tree_task, &children[i]);
+    }
+    task_group_wait(scheduler, &group);
+    node->leaves = children[0].leaves + children[1].leaves;
+}
+
+/* A few dozen ALU ops per task, so the burst measures scheduling rather than work. */
+static void sched_burst_task(TaskScheduler* scheduler, void* arg) {
+    uint64_t* slot = (uint64_t*)arg;
+    uint64_t x = (uint64_t)(uintptr_t)slot | 1ULL;
+
+    (void)scheduler;
+    for (int i = 0; i < 16; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    *slot = x | 1ULL;
+}
+
+/* Prints one stress line from the scheduler counters accumulated since the last reset. */
+static void print_scheduler_line(const char* label, bool ok, TaskScheduler* scheduler, uint64_t elapsed_ms) {
+    TaskSchedulerStats stats;
+
+    task_scheduler_stats(scheduler, &stats);
+    printf("[%s] %s | tasks=%llu | %llums | %llu tasks/s | steals=%llu (%llu.%llu%% of %llu attempts) | inline=%llu\n",
+           ok ? " OK " : "FAIL",
+           label,
+           (unsigned long long)stats.executed,
+           (unsigned long long)elapsed_ms,
+           (unsigned long long)nodes_per_second(stats.executed, elapsed_ms),
+           (unsigned long long)stats.steals,
+           (unsigned long long)(per_mille(stats.steals, stats.steal_attempts) / 10ULL),
+           (unsigned long long)(per_mille(stats.steals, stats.steal_attempts) % 10ULL),
+           (unsigned long long)stats.steal_attempts,
+           (unsigned long long)stats.inline_runs);
+}
+
+/*
+ * Work-stealing stress report on the perft scheduler: a recursive binary spawn tree, a flat
+ * burst submitted from outside the scheduler in deque-sized chunks, and the parallel perft itself (checked
+ * against the perft suite's expected counts). Returns failures.
+ */
+static int run_scheduler_stress(bool quick) {
+    TaskScheduler* scheduler = g_perft_scheduler;
+    const PerftCase* perft_cases = quick ? g_perft_cases_quick : g_perft_cases_full;
+    int perft_count = quick ? (int)(sizeof(g_perft_cases_quick) / sizeof(g_perft_cases_quick[0]))
+                            : (int)(sizeof(g_perft_cases_full) / sizeof(g_perft_cases_full[0]));
+    int tree_depth = quick ? SCHED_TREE_DEPTH_QUICK : SCHED_TREE_DEPTH_FULL;
+    int burst_count = quick ? SCHED_BURST_QUICK : SCHED_BURST_FULL;
+    int failures = 0;
+
+    printf("== Task Scheduler (%s) | workers=%d | hash=%dMB ==\n",
+           quick ? "quick" : "full",
+           task_scheduler_size(scheduler),
+           (g_perft_hash.entries != NULL) ? g_perft_hash_mb : 0);
+
+    {
+        SchedTreeNode root = {tree_depth, 0ULL};
+        Task task;
+        TaskGroup group;
+        uint64_t start_ms;
+        char label[64];
+        bool ok;
+
+        task_scheduler_reset_stats(scheduler);
+        task_group_init(&group);
+        start_ms = engine_clock_ms();
+        task_spawn(scheduler, &group, &task, sched_tree_task, &root);
+        task_group_wait(scheduler, &group);
+        ok = root.leaves == (1ULL << tree_depth);
+        snprintf(label, sizeof(label), "Spawn tree depth %d", tree_depth);
+        print_scheduler_line(label, ok, scheduler, engine_clock_ms() - start_ms);
+        failures += ok ? 0 : 1;
+    }
+
+    {
+        uint64_t* slots = (uint64_t*)calloc((size_t)burst_count, sizeof(*slots));
+        Task* tasks = (Task*)malloc((size_t)burst_count * sizeof(*tasks));
+        TaskGroup group;
+        uint64_t start_ms;
+        char label[64];
+        bool ok = true;
+
+        if (slots == NULL || tasks == NULL) {
+            printf("[FAIL] burst allocation\n");
+            failures++;
+        } else {
+            task_scheduler_reset_stats(scheduler);
+            start_ms = engine_clock_ms();
+            /* Chunks that fit the submission deque; past its capacity spawns would run inline. */
+            for (int base = 0; base < burst_count; base += TASK_DEQUE_CAPACITY) {
+                int end = (burst_count - base > TASK_DEQUE_CAPACITY) ? base + TASK_DEQUE_CAPACITY : burst_count;
+
+                task_group_init(&group);
+                for (int i = base; i < end; ++i) {
+                    task_spawn(scheduler, &group, &tasks[i], sched_burst_task, &slots[i]);
+                }
+                task_group_wait(scheduler, &group);
+            }
+            for (int i = 0; i < burst_count; ++i) {
+                ok = ok && slots[i] != 0ULL;
+            }
+            snprintf(label, sizeof(label), "External burst x%d (chunks of %d)", burst_count, TASK_DEQUE_CAPACITY);
+            print_scheduler_line(label, ok, scheduler, engine_clock_ms() - start_ms);
+            failures += ok ? 0 : 1;
+        }
+        free(slots);
+        free(tasks);
+    }
+
+    for (int i = 0; i < perft_count; ++i) {
+        Position pos;
+        uint64_t start_ms;
+        uint64_t nodes;
+        bool ok;
+
+        if (!position_set_from_fen(&pos, perft_cases[i].fen)) {
+            printf("[FAIL] %s | invalid FEN\n", perft_cases[i].name);
+            failures++;
+            continue;
+        }
+
+        task_scheduler_reset_stats(scheduler);
+        start_ms = engine_clock_ms();
+        nodes = perft_parallel(&pos, perft_cases[i].depth);
+        ok = nodes == perft_cases[i].expected_nodes;
+        print_scheduler_line(perft_cases[i].name, ok, scheduler, engine_clock_ms() - start_ms);
+        if (!ok) {
+            printf("       expected %llu nodes, got %llu\n",
+                   (unsigned long long)perft_cases[i].expected_nodes,
+                   (unsigned long long)nodes);
+            failures++;
         }
     }
 
@@ -284,16 +1690,34 @@ static int run_tactical_suite(void) {
 
 /* Prints CLI usage for bench tool. */
 static void print_usage(const char* exe_name) {
-    printf("Usage: %s [--quick] [--perft] [--tactics]\n", exe_name);
+    printf("Usage: %s [--quick|--deep] [--perft] [--tactics] [--smp] [--sched] [--ttmem] [--slider magic|pext]\n", exe_name);
+    printf("       [--threads N] [--hash MB] [--tt MB] [--divide DEPTH [--fen \"<fen>\"]]\n");
     printf("  --quick   Run reduced perft depths (faster)\n");
+    printf("  --deep    Run depth 6-7 perft regression cases (implies --perft)\n");
     printf("  --perft   Run only perft suite\n");
-    printf("  --tactics Run only tactical suite\n");
+    printf("  --tactics Run only tactical and search-speed suites\n");
+    printf("  --smp     Run only the Lazy SMP thread-scaling report (1-16 threads)\n");
+    printf("  --sched   Run only the work-stealing scheduler stress report (perft scheduler)\n");
+    printf("  --ttmem   Run only the TT allocation/clear/search report at several sizes\n");
+    printf("  --slider  Force slider attack backend (default: best for this CPU)\n");
+    printf("  --threads Perft/scheduler threads, the calling thread included (default: online CPUs)\n");
+    printf("  --hash    Perft hash size in MB, 0 disables (default: %d)\n", PERFT_DEFAULT_HASH_MB);
+    printf("  --tt      Search transposition table size in MB (default: engine default)\n");
+    printf("  --divide  Print per-move perft counts for --fen (default: start position)\n");
 }
 
 int main(int argc, char** argv) {
     bool quick_mode = false;
+    bool deep_mode = false;
     bool run_perft = true;
     bool run_tactics = true;
+    bool run_smp = false;
+    bool run_sched = false;
+    bool run_ttmem = false;
+    bool threads_set = false;
+    bool single_mode;
+    int divide_depth = 0;
+    const char* divide_fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
     int failures = 0;
 
     engine_init();
@@ -302,10 +1726,62 @@ int main(int argc, char** argv) {
     for (int i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "--quick") == 0) {
             quick_mode = true;
+        } else if (strcmp(argv[i], "--deep") == 0) {
+            deep_mode = true;
+            run_tactics = false;
         } else if (strcmp(argv[i], "--perft") == 0) {
             run_tactics = false;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            g_perft_threads = atoi(argv[++i]);
+            if (g_perft_threads < 1 || g_perft_threads > PERFT_MAX_THREADS) {
+                print_usage(argv[0]);
+                return 2;
+            }
+            threads_set = true;
+        } else if (strcmp(argv[i], "--hash") == 0 && i + 1 < argc) {
+            g_perft_hash_mb = atoi(argv[++i]);
+            if (g_perft_hash_mb < 0) {
+                print_usage(argv[0]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--tt") == 0 && i + 1 < argc) {
+            if (!engine_set_hash_size(atoi(argv[++i]))) {
+                printf("Could not allocate %sMB transposition table.\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--divide") == 0 && i + 1 < argc) {
+            divide_depth = atoi(argv[++i]);
+            if (divide_depth < 1) {
+                print_usage(argv[0]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--fen") == 0 && i + 1 < argc) {
+            divide_fen = argv[++i];
         } else if (strcmp(argv[i], "--tactics") == 0) {
             run_perft = false;
+        } else if (strcmp(argv[i], "--smp") == 0) {
+            run_smp = true;
+        } else if (strcmp(argv[i], "--sched") == 0) {
+            run_sched = true;
+        } else if (strcmp(argv[i], "--ttmem") == 0) {
+            run_ttmem = true;
+        } else if (strcmp(argv[i], "--slider") == 0 && i + 1 < argc) {
+            SliderBackend backend;
+
+            i++;
+            if (strcmp(argv[i], "magic") == 0) {
+                backend = SLIDER_BACKEND_MAGIC;
+            } else if (strcmp(argv[i], "pext") == 0) {
+                backend = SLIDER_BACKEND_PEXT;
+            } else {
+                print_usage(argv[0]);
+                return 2;
+            }
+
+            if (!engine_set_slider_backend(backend)) {
+                printf("Slider backend '%s' is not supported on this CPU.\n", argv[i]);
+                return 2;
+            }
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             print_usage(argv[0]);
             return 0;
@@ -320,13 +1796,65 @@ int main(int argc, char** argv) {
         return 2;
     }
 
-    if (run_perft) {
-        failures += run_perft_suite(quick_mode);
+    if (!threads_set) {
+        g_perft_threads = chess_cpu_count();
+        if (g_perft_threads > PERFT_MAX_THREADS) {
+            g_perft_threads = PERFT_MAX_THREADS;
+        }
     }
-    if (run_tactics) {
-        failures += run_tactical_suite();
+    g_perft_scheduler = task_scheduler_create(g_perft_threads - 1);
+    if (g_perft_scheduler == NULL) {
+        printf("Could not start perft worker threads.\n");
+        return 2;
     }
+    if (!perft_hash_init(g_perft_hash_mb)) {
+        printf("Could not allocate %dMB perft hash.\n", g_perft_hash_mb);
+        task_scheduler_destroy(g_perft_scheduler);
+        return 2;
+    }
+
+    printf("Slider attacks: %s\n\n",
+           (engine_get_slider_backend() == SLIDER_BACKEND_PEXT) ? "pext" : "magic");
 
+    /* Single-purpose modes report on their own; every path ends in the cleanup below. */
+    single_mode = run_ttmem || run_smp || run_sched || divide_depth > 0;
+    if (run_ttmem) {
+        failures = run_tt_memory_report(quick_mode);
+    } else if (run_smp) {
+        failures = run_thread_scaling_suite(quick_mode);
+    } else if (run_sched) {
+        failures = run_scheduler_stress(quick_mode);
+    } else if (divide_depth > 0) {
+        failures = run_perft_divide(divide_fen, divide_depth);
+    } else {
+        if (deep_mode) {
+            failures += run_perft_suite(g_perft_cases_deep, (int)(sizeof(g_perft_cases_deep) / sizeof(g_perft_cases_deep[0])), "deep");
+        } else if (run_perft) {
+            if (quick_mode) {
+                failures += run_perft_suite(g_perft_cases_quick, (int)(sizeof(g_perft_cases_quick) / sizeof(g_perft_cases_quick[0])), "quick");
+            } else {
+                failures += run_perft_suite(g_perft_cases_full, (int)(sizeof(g_perft_cases_full) / sizeof(g_perft_cases_full[0])), "full");
+            }
+            failures += run_make_unmake_comparison(quick_mode);
+            failures += run_staged_generator_check(quick_mode);
+        }
+        if (run_tactics) {
+            failures += run_tactical_suite();
+            failures += run_search_speed_suite(quick_mode);
+            failures += run_search_handle_check();
+            failures += run_time_manager_check(quick_mode);
+            failures += run_node_limit_check(quick_mode);
+            failures += run_engine_instance_check(quick_mode);
+            failures += run_thread_pool_check();
+        }
+    }
+    perft_hash_free();
+    task_scheduler_destroy(g_perft_scheduler);
+    chess_pool_shutdown_shared();
+
+    if (single_mode) {
+        return (failures == 0) ? 0 : 1;
+    }
     if (failures == 0) {
         printf("All engine benchmarks passed.\n");
         return 0;